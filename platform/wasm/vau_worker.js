@@ -102,6 +102,20 @@ workerMethods.openDocument = function (str) {
 	var p= allocateUTF8(str);
 	libvau._wasm_open_document(p);
 	libvau._free(p)
+	scheduleTypesetting();
+}
+
+// Only the first page is typeset when opening a document; the remainder
+// of the document is typeset in between the handling of other requests.
+let typesettingScheduled = false;
+function scheduleTypesetting() {
+	if (typesettingScheduled) return;
+	typesettingScheduled = true;
+	setTimeout(() => {
+		typesettingScheduled = false;
+		if (!libvau._wasm_typeset_continue())
+			scheduleTypesetting();
+	}, 0);
 }
 
 workerMethods.getPagePixmap = function (page) {
@@ -789,6 +789,9 @@
       (meti (hlist // (text "New style page breaking"))
         (toggle (set-boolean-preference "new style page breaking" answer)
                 (get-boolean-preference "new style page breaking")))
+      (meti (hlist // (text "New style line breaking"))
+        (toggle (set-boolean-preference "new style line breaking" answer)
+                (get-boolean-preference "new style line breaking")))
       (assuming (os-macos?)
         (meti (hlist // (text "Use native menubar"))
           (toggle (set-boolean-preference "use native menubar" answer)
@@ -842,6 +845,9 @@
     (meti (hlist // (text "New style page breaking"))
       (toggle (set-boolean-preference "new style page breaking" answer)
               (get-boolean-preference "new style page breaking")))
+    (meti (hlist // (text "New style line breaking"))
+      (toggle (set-boolean-preference "new style line breaking" answer)
+              (get-boolean-preference "new style line breaking")))
     ;;(meti (hlist // (text "New bibliography dialogue"))
     ;;  (toggle
     ;;   (set-boolean-preference "gui:new bibliography dialogue" answer)
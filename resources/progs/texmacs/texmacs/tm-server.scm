@@ -77,6 +77,9 @@
 (define (notify-new-page-breaking var val)
   (noop))
 
+(define (notify-new-line-breaking var val)
+  (set-new-line-breaking (== val "on")))
+
 (define (get-default-native-menubar)
   (if (qt4-gui?) "on" "off"))
 
@@ -125,7 +128,11 @@
   ("experimental alpha" "on" notify-tool)
   ("new style fonts" "on" notify-new-fonts)
   ("bitmap effects" "on" notify-tool)
+  ("mupdf store limit" "default" noop)
+  ("mupdf cache limit" "default" noop)
+  ("render glyph metrics" "off" noop)
   ("new style page breaking" "on" notify-new-page-breaking)
+  ("new style line breaking" "on" notify-new-line-breaking)
   ("open console on errors" "on" noop)
   ("open console on warnings" "on" noop)
   ("gui:line-input:autocommit" "on" noop)
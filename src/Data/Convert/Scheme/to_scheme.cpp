@@ -17,10 +17,9 @@
 * Handling escape characters
 ******************************************************************************/
 
-string
-slash (string s) {
+static void
+slash (string& r, string s) {
   int i, n= N(s);
-  string r;
   for (i=0; i<n; i++)
     switch (s[i]) {
     case '(':
@@ -51,6 +50,12 @@ slash (string s) {
     default:
       r << s[i];
     }
+}
+
+string
+slash (string s) {
+  string r;
+  slash (r, s);
   return r;
 }
 
@@ -63,7 +68,7 @@ scheme_tree_to_string (string& out, scheme_tree p) {
   if (!is_tuple (p)) {
     string s= p->label;
     if (is_quoted (s)) out << scm_quote (raw_unquote (s));
-    else out << slash (s);
+    else slash (out, s);
   }
   else {
     if (is_tuple (p, "\'", 1)) {
@@ -93,8 +98,10 @@ string
 scheme_tree_to_block (scheme_tree p) {
   string out;
   int i, n= N(p);
-  for (i=0; i<n; i++)
-    out << scheme_tree_to_string (p[i]) << "\n";
+  for (i=0; i<n; i++) {
+    scheme_tree_to_string (out, p[i]);
+    out << "\n";
+  }
   return out;
 }
 
@@ -0,0 +1,223 @@
+
+/******************************************************************************
+* MODULE     : binarytm.cpp
+* DESCRIPTION: compact binary serialization of TeXmacs trees
+* COPYRIGHT  : (C) 2026  Massimiliano Gubinelli
+*******************************************************************************
+* The binary format consists of
+*   - the magic header "TMB" followed by the format version 1,
+*   - a table with the names of the labels which occur in the tree,
+*   - a pool with the distinct strings which occur in the tree,
+*   - the nodes of the tree in prefix order.
+* All integers are stored as variable length unsigned integers, seven bits
+* at a time, starting with the least significant ones.  Strings in the
+* table and the pool are stored as their length followed by their bytes.
+* A node is encoded by 2*i for the i-th string of the pool and by 2*j+1
+* followed by the arity and the children for the j-th label of the table.
+* Since the data contains no pointers, it may be read from a mapped file
+* without relocation.  The reader builds the complete tree at once.  Each
+* string of the pool is extracted from the data when it is referenced for
+* the first time; all its occurrences share the characters, but not the
+* atomic trees, which may be modified later on.
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#include "convert.hpp"
+
+#define BINARY_MAGIC "TMB\001"
+#define BINARY_MAGIC_LENGTH 4
+
+/******************************************************************************
+* Conversion of trees into binary strings
+******************************************************************************/
+
+static void
+write_int (string& s, unsigned int i) {
+  while (i >= 128) {
+    s << ((char) ((i & 127) | 128));
+    i >>= 7;
+  }
+  s << ((char) i);
+}
+
+static void
+write_string (string& s, string what) {
+  write_int (s, N(what));
+  s << what;
+}
+
+struct tmb_writer {
+  hashmap<int,int>    label_code;   // label -> index in label table
+  hashmap<string,int> string_code;  // string -> index in string pool
+  string labels;                    // the label table
+  string strings;                   // the string pool
+  string nodes;                     // the node stream
+
+  tmb_writer (): label_code (-1), string_code (-1) {}
+  void write (tree t);
+  string result ();
+};
+
+void
+tmb_writer::write (tree t) {
+  if (is_compound (t)) {
+    int l= (int) L(t);
+    int* c= label_code->locate (l);
+    int code;
+    if (c != NULL) code= *c;
+    else {
+      code= N (label_code);
+      label_code (l)= code;
+      write_string (labels, as_string (L(t)));
+    }
+    int i, n= N(t);
+    write_int (nodes, (((unsigned int) code) << 1) + 1);
+    write_int (nodes, n);
+    for (i=0; i<n; i++) write (t[i]);
+  }
+  else {
+    // blackboxes of generic trees cannot be serialized
+    string s= (is_atomic (t)? t->label: string (""));
+    int* c= string_code->locate (s);
+    int code;
+    if (c != NULL) code= *c;
+    else {
+      code= N (string_code);
+      string_code (s)= code;
+      write_string (strings, s);
+    }
+    write_int (nodes, ((unsigned int) code) << 1);
+  }
+}
+
+string
+tmb_writer::result () {
+  string r (BINARY_MAGIC);
+  write_int (r, N (label_code));
+  r << labels;
+  write_int (r, N (string_code));
+  r << strings << nodes;
+  return r;
+}
+
+string
+tree_to_texmacs_binary (tree t) {
+  tmb_writer tmw;
+  tmw.write (t);
+  return tmw.result ();
+}
+
+/******************************************************************************
+* Conversion of binary strings into trees
+******************************************************************************/
+
+struct tmb_reader {
+  string buf;                 // the binary data
+  int    pos;                 // the current position of the reader
+  bool   ok;                  // false as soon as the data turned out bad
+  array<tree_label> labels;   // the label table
+  array<int>  offsets;        // positions of the strings in the pool
+  array<string> strings;      // the strings of the pool
+  array<bool> done;           // which strings were already materialized
+
+  tmb_reader (string buf2):
+    buf (buf2), pos (BINARY_MAGIC_LENGTH), ok (true) {}
+  unsigned int read_int ();
+  int  skip_string ();
+  bool read_header ();
+  string read_string (int i);
+  tree read ();
+};
+
+unsigned int
+tmb_reader::read_int () {
+  unsigned int r= 0;
+  int shift= 0, n= N(buf);
+  while (pos < n && shift < 32) {
+    unsigned char c= (unsigned char) buf[pos++];
+    r += ((unsigned int) (c & 127)) << shift;
+    if ((c & 128) == 0) return r;
+    shift += 7;
+  }
+  ok= false;
+  return 0;
+}
+
+int
+tmb_reader::skip_string () {
+  unsigned int l= read_int ();
+  int start= pos;
+  if (l > (unsigned int) (N(buf) - pos)) { ok= false; return start; }
+  pos += (int) l;
+  return start;
+}
+
+bool
+tmb_reader::read_header () {
+  int i, n= read_int ();
+  for (i=0; i<n && ok; i++) {
+    int start= skip_string ();
+    if (ok) labels << make_tree_label (buf (start, pos));
+    if (ok && ((int) labels[i]) <= 0) ok= false;
+  }
+  n= read_int ();
+  for (i=0; i<n && ok; i++) {
+    offsets << pos;
+    (void) skip_string ();
+  }
+  if (ok) {
+    strings= array<string> (N(offsets));
+    done= array<bool> (N(offsets));
+    for (i=0; i<n; i++) done[i]= false;
+  }
+  return ok;
+}
+
+string
+tmb_reader::read_string (int i) {
+  if (done[i]) return strings[i];
+  int save= pos;
+  pos= offsets[i];
+  int start= skip_string ();
+  strings[i]= buf (start, pos);
+  done[i]= true;
+  pos= save;
+  return strings[i];
+}
+
+tree
+tmb_reader::read () {
+  unsigned int code= read_int ();
+  if (!ok) return "";
+  if ((code & 1) == 0) {
+    code >>= 1;
+    if (code >= (unsigned int) N(offsets)) { ok= false; return ""; }
+    return tree (read_string ((int) code));
+  }
+  code >>= 1;
+  unsigned int i, n= read_int ();
+  if (!ok || code >= (unsigned int) N(labels) ||
+      n > (unsigned int) (N(buf) - pos)) { ok= false; return ""; }
+  tree t (labels[code], (int) n);
+  for (i=0; i<n && ok; i++) t[i]= read ();
+  return t;
+}
+
+bool
+is_texmacs_binary (string s) {
+  return starts (s, BINARY_MAGIC);
+}
+
+tree
+texmacs_binary_to_tree (string s) {
+  tree error (ERROR, "bad format or data");
+  if (!is_texmacs_binary (s)) return error;
+  tmb_reader tmr (s);
+  if (!tmr.read_header ()) return error;
+  tree t= tmr.read ();
+  if (!tmr.ok || tmr.pos != N(s)) return error;
+  return t;
+}
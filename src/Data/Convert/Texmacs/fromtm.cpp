@@ -19,6 +19,36 @@
 * Conversion of TeXmacs strings of the present format to TeXmacs trees
 ******************************************************************************/
 
+#define TOKEN_SPACE     0
+#define TOKEN_RETURN    1
+#define TOKEN_OPEN      2
+#define TOKEN_BAR       3
+#define TOKEN_CLOSE     4
+#define TOKEN_RAW       5
+#define TOKEN_OPEN_TAG  6
+#define TOKEN_OPEN_ARG  7
+#define TOKEN_OPEN_END  8
+
+static inline bool
+is_delimiter (int c) {
+  // the characters which end a run of plain text
+  switch (c) {
+  case '\\': case '\t': case '\r': case '\n':
+  case ' ': case '<': case '|': case '>':
+    return true;
+  default:
+    return false;
+  }
+}
+
+static inline int
+hex_value (char c) {
+  if ((c >= '0') && (c <= '9')) return c - '0';
+  if ((c >= 'A') && (c <= 'F')) return c + 10 - 'A';
+  if ((c >= 'a') && (c <= 'f')) return c + 10 - 'a';
+  return 0;
+}
+
 struct tm_reader {
   string  version;            // document was composed using this version
   hashmap<string,int> codes;  // codes for to present version
@@ -28,6 +58,7 @@ struct tm_reader {
   string  buf;                // the string being read from
   int     pos;                // the current position of the reader
   string  last;               // last read string
+  array<string> tokens;       // shared strings for the frequent tokens
 
   tm_reader (string buf2):
     version (TEXMACS_VERSION),
@@ -35,24 +66,34 @@ struct tm_reader {
     EXPAND_APPLY (EXPAND),
     backslash_ok (true),
     with_extensions (true),
-    buf (buf2), pos (0), last ("") {}
+    buf (buf2), pos (0), last ("") { init (); }
   tm_reader (string buf2, string version2):
     version (version2),
     codes (get_codes (version)),
     EXPAND_APPLY (version_inf (version, "0.3.3.22")? APPLY: EXPAND),
     backslash_ok (version_inf (version, "1.0.1.23")? false: true),
     with_extensions (version_inf (version, "1.0.2.4")? false: true),
-    buf (buf2), pos (0), last ("") {}
+    buf (buf2), pos (0), last ("") { init (); }
 
+  void   init ();
   int    skip_blank ();
   string decode (string s);
-  string read_char ();
+  int    read_char ();
   string read_next ();
   string read_function_name ();
+  tree   read_tag (string name);
   tree   read_apply (string s, bool skip_flag);
   tree   read (bool skip_flag);
 };
 
+void
+tm_reader::init () {
+  // the tokens TOKEN_SPACE, ..., TOKEN_OPEN_END, which are returned often
+  tokens << string (" ") << string ("\n") << string ("<") << string ("|")
+         << string (">") << string ("<#") << string ("<\\") << string ("<|")
+         << string ("</");
+}
+
 int
 tm_reader::skip_blank () {
   int n=0;
@@ -69,8 +110,12 @@ tm_reader::skip_blank () {
 string
 tm_reader::decode (string s) {
   int i, n=N(s);
+  for (i=0; i<n-1; i++)
+    if (s[i] == '\\') break;
+  if (i >= n-1) return s;
   string r;
-  for (i=0; i<n; i++)
+  r << slice (s, 0, i);
+  for (; i<n; i++)
     if (((i+1)<n) && (s[i]=='\\')) {
       i++;
       if (s[i] == ';');
@@ -86,76 +131,77 @@ tm_reader::decode (string s) {
   return r;
 }
 
-string
+int
 tm_reader::read_char () {
   while (((pos+1) < N(buf)) && (buf[pos] == '\\') && (buf[pos+1] == '\n')) {
     pos += 2;
     skip_spaces (buf, pos);
   }
-  if (pos >= N(buf)) return "";
-  pos++;
-  return buf (pos-1, pos);
+  if (pos >= N(buf)) return -1;
+  return (unsigned char) buf[pos++];
 }
 
 string
 tm_reader::read_next () {
   int old_pos= pos;
-  string c= read_char ();
-  if (c == "") return c;
-  switch (c[0]) {
+  int c= read_char ();
+  if (c < 0) return "";
+  switch (c) {
   case '\t':
   case '\n':
   case '\r':
   case ' ': 
     pos--;
-    if (skip_blank () <= 1) return " ";
-    else return "\n";
+    if (skip_blank () <= 1) return tokens[TOKEN_SPACE];
+    else return tokens[TOKEN_RETURN];
   case '<':
     {
       old_pos= pos;
       c= read_char ();
-      if (c == "") return "";
-      if (c == "#") return "<#";
-      if ((c == "\\") || (c == "|") || (c == "/")) return "<" * c;
-      if (is_iso_alpha (c[0]) || (c == ">")) {
-        pos= old_pos;
-        return "<";
-      }
+      if (c < 0) return "";
+      if (c == '#') return tokens[TOKEN_RAW];
+      if (c == '\\') return tokens[TOKEN_OPEN_TAG];
+      if (c == '|') return tokens[TOKEN_OPEN_ARG];
+      if (c == '/') return tokens[TOKEN_OPEN_END];
       pos= old_pos;
-      return "<";
-      /*
-      string d= read_char ();
-      if ((d == "\\") || (d == "|") || (d == "/")) return "<" * c * d;
-      pos= old_pos;
-      return "<" * c;
-      */
+      return tokens[TOKEN_OPEN];
     }
   case '|':
+    return tokens[TOKEN_BAR];
   case '>':
-    return c;
+    return tokens[TOKEN_CLOSE];
   }
 
+  // Runs of plain characters are copied at once; in the most common case
+  // of a run which is directly followed by a delimiter, the token is a
+  // mere substring of the buffer
   string r;
+  int n= N(buf);
   pos= old_pos;
   while (true) {
+    int start= pos;
+    while (pos < n && !is_delimiter ((unsigned char) buf[pos])) pos++;
+    if (pos > start) {
+      if (N(r) == 0 && (pos >= n || buf[pos] != '\\'))
+        return buf (start, pos);
+      r << slice (buf, start, pos);
+    }
     old_pos= pos;
     c= read_char ();
-    if (c == "") return r;
-    else if (c == "\\") {
-      if ((pos < N(buf)) && (buf[pos] == '\\') && backslash_ok) {
-        r << c << "\\";
+    if (c < 0) return r;
+    else if (c == '\\') {
+      if ((pos < n) && (buf[pos] == '\\') && backslash_ok) {
+        r << "\\\\";
         pos++;
       }
-      else r << c << read_char ();
+      else {
+        r << '\\';
+        c= read_char ();
+        if (c >= 0) r << ((char) c);
+      }
     }
-    else if (c == "\t") break;
-    else if (c == "\r") break;
-    else if (c == "\n") break;
-    else if (c == " ") break;
-    else if (c == "<") break;
-    else if (c == "|") break;
-    else if (c == ">") break;
-    else r << c;
+    else if (is_delimiter (c)) break;
+    else r << ((char) c);
   }
   pos= old_pos;
   return r;
@@ -173,6 +219,15 @@ tm_reader::read_function_name () {
   return name;
 }
 
+tree
+tm_reader::read_tag (string name) {
+  int* code= codes->locate (name);
+  if (code != NULL) return tree ((tree_label) *code);
+  tree_label l= make_tree_label (name);
+  if (!with_extensions) return tree (EXPAND_APPLY, name);
+  return tree (l);
+}
+
 static void
 get_collection (tree& u, tree t) {
   if (is_func (t, COLLECTION) ||
@@ -188,13 +243,7 @@ get_collection (tree& u, tree t) {
 tree
 tm_reader::read_apply (string name, bool skip_flag) {
   // cout << "Read apply " << name << INDENT << LF;
-  tree t (make_tree_label (name));
-  if (!with_extensions)
-    t= tree (EXPAND_APPLY, name);
-  if (codes->contains (name)) {
-    // cout << "  " << name << " -> " << as_string ((tree_label) codes [name]) << "\n";
-    t= tree ((tree_label) codes [name]);
-  }
+  tree t= read_tag (name);
 
   bool closed= !skip_flag;
   while (pos < N(buf)) {
@@ -273,7 +322,7 @@ tm_reader::read (bool skip_flag) {
       else if (last[N(last)-1] == '#') {
         string r;
         while ((buf[pos] != '>') && (pos+2<N(buf))) {
-          r << ((char) from_hexadecimal (buf (pos, pos+2)));
+          r << ((char) ((hex_value (buf[pos]) << 4) + hex_value (buf[pos+1])));
           pos += 2;
         }
         if (buf[pos] == '>') pos++;
@@ -294,16 +343,7 @@ tm_reader::read (bool skip_flag) {
           last= "|";
           C << read_apply (name, false);
         }
-        else {
-          tree t (make_tree_label (name));
-          if (!with_extensions)
-            t= tree (EXPAND_APPLY, name);
-          if (codes->contains (name)) {
-            // cout << name << " -> " << as_string ((tree_label) codes [name]) << "\n";
-            t= tree ((tree_label) codes [name]);
-          }
-          C << t;
-        }
+        else C << read_tag (name);
       }
     }
     else if (last == " ") spc_flag= true;
@@ -409,6 +449,14 @@ texmacs_document_to_tree (string s) {
     }
     return upgrade (doc, version);
   }
+
+  if (is_texmacs_binary (s)) {
+    tree doc= texmacs_binary_to_tree (s);
+    if (!is_document (doc) || N(doc) == 0 ||
+        !is_compound (doc[0], "TeXmacs", 1) || !is_atomic (doc[0][0]))
+      return error;
+    return upgrade (doc, doc[0][0]->label);
+  }
   return error;
 }
 
@@ -49,7 +49,7 @@ tm_writer::cr () {
     if ((buf[i] != ' ') || ((i>0) && (buf[i-1] == '\\')))
       break;
   if (i<n-1) {
-    buf= buf (0, i+1);
+    buf->resize (i+1);
     n  = n- N(buf);
     for (i=0; i<n; i++) buf << "\\ ";
   }
@@ -103,8 +103,8 @@ tm_writer::flush () {
       }
     }
   }
-  spc= "";
-  tmp= "";
+  spc->resize (0);
+  tmp->resize (0);
 }
 
 void
@@ -41,6 +41,9 @@ scheme_tree compute_index (url u);
 tree   texmacs_to_tree (string s);
 tree   texmacs_document_to_tree (string s);
 string tree_to_texmacs (tree t);
+string tree_to_texmacs_binary (tree t);
+tree   texmacs_binary_to_tree (string s);
+bool   is_texmacs_binary (string s);
 tree   extract (tree doc, string attr);
 tree   extract_document (tree doc);
 tree   change_doc_attr (tree doc, string attr, tree val);
@@ -104,6 +104,7 @@ style_invalidate_cache () {
     tm_delete<style_data_rep> (sd);
     sd= NULL;
   }
+  intern_reset ();
   init_style_data ();
   remove ("$TEXMACS_HOME_PATH/system/cache" * url_wildcard ("__*"));
 }
@@ -114,9 +115,10 @@ style_set_cache (tree style, hashmap<string,tree> H, tree t) {
   // cout << "set cache " << style << LF;
   sd->style_cache (copy (style))= H;
   sd->style_drd   (copy (style))= t;
-  url name ("$TEXMACS_HOME_PATH/system/cache", cache_file_name (style));
+  url name ("$TEXMACS_HOME_PATH/system/cache",
+            cache_file_name (style) * ".tmb");
   if (!exists (name)) {
-    save_string (name, tree_to_scheme (tuple ((tree) H, t)));
+    save_string (name, tree_to_texmacs_binary (tuple ((tree) H, t)));
     // cout << "saved " << name << LF;
   }
 }
@@ -133,15 +135,19 @@ style_get_cache (tree style, hashmap<string,tree>& H, tree& t, bool& f) {
   }
   else {
     string s;
-    url name ("$TEXMACS_HOME_PATH/system/cache", cache_file_name (style));
+    url name ("$TEXMACS_HOME_PATH/system/cache",
+              cache_file_name (style) * ".tmb");
     if (exists (name) && (!load_string (name, s, false))) {
       //cout << "loaded " << name << LF;
-      tree p= scheme_to_tree (s);
-      H= hashmap<string,tree> (UNINIT, p[0]);
-      t= p[1];
-      sd->style_cache (copy (style))= H;
-      sd->style_drd   (copy (style))= t;
-      f= true;
+      tree p= texmacs_binary_to_tree (s);
+      if (is_tuple (p) && N(p) == 2) {
+        p= intern (p);
+        H= hashmap<string,tree> (UNINIT, p[0]);
+        t= p[1];
+        sd->style_cache (copy (style))= H;
+        sd->style_drd   (copy (style))= t;
+        f= true;
+      }
     }
   }
 }
@@ -14,6 +14,7 @@
 #include "converter.hpp"
 #include "scheme.hpp"
 #include "ntuple.hpp"
+#include <string.h>
 
 /******************************************************************************
 * Tests for characters
@@ -960,15 +961,15 @@ starts (string s, const string what) {
 
 bool
 ends (string s, const char* what) {
-  string r (what);
-  if (N(r) > N(s)) return false;
-  return s (N(s)-N(r), N(s)) == r;
+  int m= strlen (what);
+  if (m > N(s)) return false;
+  return test (s, N(s)-m, what);
 }
 
 bool
 ends (string s, const string r) {
   if (N(r) > N(s)) return false;
-  return s (N(s)-N(r), N(s)) == r;
+  return test (s, N(s)-N(r), r);
 }
 
 bool
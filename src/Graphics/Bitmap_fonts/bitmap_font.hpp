@@ -12,6 +12,7 @@
 #ifndef BITMAP_FONT_H
 #define BITMAP_FONT_H
 #include "resource.hpp"
+#include "char_table.hpp"
 
 class frame;
 
@@ -91,7 +91,7 @@ struct distorted_font_glyphs_rep: public font_glyphs_rep {
   font_glyphs fng;
   tree kind;
   SI em;
-  hashmap<int,glyph> gs;
+  char_table<glyph> gs;
   distorted_font_glyphs_rep (string name, font_glyphs fng2, tree k2, int e2):
     font_glyphs_rep (name), fng (fng2), kind (k2), em (e2), gs (error_glyph) {}
   glyph& get (int c) {
@@ -27,7 +27,7 @@ extern string functional_to_string (tree t);
 struct effected_font_metric_rep: public font_metric_rep {
   font_metric fnm;
   effect eff;
-  hashmap<int,pointer> ms;
+  char_table<pointer> ms;
   effected_font_metric_rep (string name, font_metric fnm2, effect eff2):
     font_metric_rep (name), fnm (fnm2), eff (eff2), ms (error_metric) {}
   bool exists (int c) { return fnm->exists (c); }
@@ -128,7 +128,7 @@ effected (glyph gl, effect eff) {
 struct effected_font_glyphs_rep: public font_glyphs_rep {
   font_glyphs fng;
   effect eff;
-  hashmap<int,glyph> gs;
+  char_table<glyph> gs;
   effected_font_glyphs_rep (string name, font_glyphs fng2, effect e2):
     font_glyphs_rep (name), fng (fng2), eff (e2), gs (error_glyph) {}
   glyph& get (int c) {
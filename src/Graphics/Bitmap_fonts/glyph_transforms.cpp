@@ -24,7 +24,7 @@ extern metric error_metric;
 struct slanted_font_metric_rep: public font_metric_rep {
   font_metric fnm;
   double slant;
-  hashmap<int,pointer> ms;
+  char_table<pointer> ms;
   slanted_font_metric_rep (string name, font_metric fnm2, double slant2):
     font_metric_rep (name), fnm (fnm2), slant (slant2), ms (error_metric) {}
   bool exists (int c) { return fnm->exists (c); }
@@ -91,7 +91,7 @@ slanted (glyph gl, double slant) {
 struct slanted_font_glyphs_rep: public font_glyphs_rep {
   font_glyphs fng;
   double slant;
-  hashmap<int,glyph> gs;
+  char_table<glyph> gs;
   slanted_font_glyphs_rep (string name, font_glyphs fng2, double slant2):
     font_glyphs_rep (name), fng (fng2), slant (slant2), gs (error_glyph) {}
   glyph& get (int c) {
@@ -115,7 +115,7 @@ slanted (font_glyphs fng, double slant) {
 struct stretched_font_metric_rep: public font_metric_rep {
   font_metric fnm;
   double xf, yf;
-  hashmap<int,pointer> ms;
+  char_table<pointer> ms;
   stretched_font_metric_rep (string name, font_metric fnm2,
                              double xf2, double yf2):
     font_metric_rep (name), fnm (fnm2),
@@ -199,7 +199,7 @@ stretched (glyph gl, double xf, double yf) {
 struct stretched_font_glyphs_rep: public font_glyphs_rep {
   font_glyphs fng;
   double xf, yf;
-  hashmap<int,glyph> gs;
+  char_table<glyph> gs;
   stretched_font_glyphs_rep (string name, font_glyphs fng2,
                              double xf2, double yf2):
     font_glyphs_rep (name), fng (fng2),
@@ -274,7 +274,7 @@ struct extended_font_glyphs_rep: public font_glyphs_rep {
   font_glyphs fng;
   double xf;
   SI penw;
-  hashmap<int,glyph> gs;
+  char_table<glyph> gs;
   extended_font_glyphs_rep (string name, font_glyphs fng2, double xf2, SI p2):
     font_glyphs_rep (name), fng (fng2),
     xf (xf2), penw (p2), gs (error_glyph) {}
@@ -300,7 +300,7 @@ extended (font_glyphs fng, double xf, SI penw) {
 struct mono_font_metric_rep: public font_metric_rep {
   font_metric fnm;
   SI lw, phw;
-  hashmap<int,pointer> ms;
+  char_table<pointer> ms;
   mono_font_metric_rep (string name, font_metric fnm2, SI lw2, SI phw2):
     font_metric_rep (name), fnm (fnm2),
     lw (lw2), phw (phw2), ms (error_metric) {}
@@ -365,7 +365,7 @@ mono (glyph gl, SI lw, SI phw) {
 struct mono_font_glyphs_rep: public font_glyphs_rep {
   font_glyphs fng;
   SI lw, phw;
-  hashmap<int,glyph> gs;
+  char_table<glyph> gs;
   mono_font_glyphs_rep (string name, font_glyphs fng2, SI lw2, SI phw2):
     font_glyphs_rep (name), fng (fng2),
     lw (lw2), phw (phw2), gs (error_glyph) {}
@@ -392,7 +392,7 @@ mono (font_glyphs fng, SI lw, SI phw) {
 struct bolden_font_metric_rep: public font_metric_rep {
   font_metric fnm;
   SI dtot, dver;
-  hashmap<int,pointer> ms;
+  char_table<pointer> ms;
   bolden_font_metric_rep (string name, font_metric fnm2, SI dtot2, SI dver2):
     font_metric_rep (name), fnm (fnm2),
     dtot (dtot2), dver (dver2), ms (error_metric) {}
@@ -467,7 +467,7 @@ bolden (glyph gl, SI dpen, SI dtot, SI dver) {
 struct bolden_font_glyphs_rep: public font_glyphs_rep {
   font_glyphs fng;
   SI dpen, dtot, dver;
-  hashmap<int,glyph> gs;
+  char_table<glyph> gs;
   bolden_font_glyphs_rep (string name, font_glyphs fng2,
                           SI dpen2, SI dtot2, SI dver2):
     font_glyphs_rep (name), fng (fng2),
@@ -738,7 +738,7 @@ make_bbb (glyph gl, int code, SI penw, SI penh, SI fat) {
 struct make_bbb_font_glyphs_rep: public font_glyphs_rep {
   font_glyphs fng;
   SI penw, penh, fatw;
-  hashmap<int,glyph> gs;
+  char_table<glyph> gs;
   make_bbb_font_glyphs_rep (string name, font_glyphs fng2,
 			    SI pw, SI ph, SI fw):
     font_glyphs_rep (name), fng (fng2),
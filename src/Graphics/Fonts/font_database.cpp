@@ -154,6 +154,7 @@ font_database_save_database (url u) {
   save_string (u, s);
   // FIXME: this should not be necessary
   remove ("$TEXMACS_PATH/system/cache/file_cache");
+  remove ("$TEXMACS_PATH/system/cache/file_cache.tmb");
   cache_refresh ();
 }
 
@@ -172,6 +173,7 @@ font_database_save_features (url u) {
   save_string (u, s);
   // FIXME: this should not be necessary
   remove ("$TEXMACS_PATH/system/cache/file_cache");
+  remove ("$TEXMACS_PATH/system/cache/file_cache.tmb");
   cache_refresh ();
 }
 
@@ -188,6 +190,7 @@ font_database_save_characteristics (url u) {
   save_string (u, s);
   // FIXME: this should not be necessary
   remove ("$TEXMACS_PATH/system/cache/file_cache");
+  remove ("$TEXMACS_PATH/system/cache/file_cache.tmb");
   cache_refresh ();
 }
 
@@ -37,9 +37,12 @@ CONCRETE(basic_character);
                    int sf=1, color fg= 0, color bg= 1):
     rep (tm_new<basic_character_rep> (c, fng, sf, fg, bg)) {};
   operator tree ();
+  friend void share (basic_character xc);
 };
 CONCRETE_CODE(basic_character);
 
+inline void share (basic_character xc) { REF_SHARE (xc.rep); }
+
 bool operator == (basic_character xc1, basic_character xc2);
 bool operator != (basic_character xc1, basic_character xc2);
 int hash (basic_character xc);
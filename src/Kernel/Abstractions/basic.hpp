@@ -13,6 +13,7 @@
 #define BASIC_H
 #include "fast_alloc.hpp"
 #include <math.h>
+#include <utility>
 
 #ifdef HAVE_INTPTR_T
 #ifdef HAVE_INTTYPES_H
@@ -173,17 +174,29 @@ void tm_sleep ();
 * concrete and abstract base structures
 ******************************************************************************/
 
+#ifdef SHARED_REF_COUNT
+#define REF_SHARED_FIELD bool ref_shared;
+#define REF_SHARED_INIT , ref_shared (false)
+#else
+#define REF_SHARED_FIELD
+#define REF_SHARED_INIT
+#endif
+
 extern int concrete_count;
 struct concrete_struct {
   int ref_count;
-  inline concrete_struct (): ref_count (1) { TM_DEBUG(concrete_count++); }
+  REF_SHARED_FIELD
+  inline concrete_struct (): ref_count (1) REF_SHARED_INIT {
+    TM_DEBUG(concrete_count++); }
   virtual inline ~concrete_struct () { TM_DEBUG(concrete_count--); }
 };
 
 extern int abstract_count;
 struct abstract_struct {
   int ref_count;
-  inline abstract_struct (): ref_count (0) { TM_DEBUG(abstract_count++); }
+  REF_SHARED_FIELD
+  inline abstract_struct (): ref_count (0) REF_SHARED_INIT {
+    TM_DEBUG(abstract_count++); }
   virtual inline ~abstract_struct () { TM_DEBUG(abstract_count--); }
 };
 
@@ -191,69 +204,105 @@ struct abstract_struct {
 * indirect structures
 ******************************************************************************/
 
-#define INC_COUNT(R) { (R)->ref_count++; }
-#define DEC_COUNT(R) { if(0==--((R)->ref_count)) { tm_delete (R);}}
+// By default, reference counts are ordinary integers, so that a handle
+// may only be used by the thread which owns it.  When SHARED_REF_COUNT
+// is defined, REF_SHARE marks an object as published to other threads;
+// from then on its count is updated atomically, while the counts of
+// all other objects keep using the non atomic fast path.
+#ifdef SHARED_REF_COUNT
+#define REF_SHARE(R) { (R)->ref_shared= true; }
+#define REF_INC(R) \
+  ((R)->ref_shared? \
+   __atomic_add_fetch (&((R)->ref_count), 1, __ATOMIC_RELAXED): \
+   ++((R)->ref_count))
+#define REF_DEC(R) \
+  ((R)->ref_shared? \
+   __atomic_sub_fetch (&((R)->ref_count), 1, __ATOMIC_ACQ_REL): \
+   --((R)->ref_count))
+#else
+#define REF_SHARE(R) {}
+#define REF_INC(R) (++((R)->ref_count))
+#define REF_DEC(R) (--((R)->ref_count))
+#endif
+
+#define INC_COUNT(R) { REF_INC (R); }
+#define DEC_COUNT(R) { if(0==REF_DEC (R)) { tm_delete (R);}}
 //#define DEC_COUNT(R) { if(0==--((R)->ref_count)) { tm_delete (R); R=NULL;}}
-#define INC_COUNT_NULL(R) { if ((R)!=NULL) (R)->ref_count++; }
+#define INC_COUNT_NULL(R) { if ((R)!=NULL) REF_INC (R); }
 /*#define DEC_COUNT_NULL(R) \
   { if ((R)!=NULL && 0==--((R)->ref_count)) { tm_delete (R); } } */
 #define DEC_COUNT_NULL(R) \
-  { if ((R)!=NULL && 0==--((R)->ref_count)) { tm_delete (R); R=NULL;} }
+  { if ((R)!=NULL && 0==REF_DEC (R)) { tm_delete (R); R=NULL;} }
+
+// Handles can be moved, in which case the reference count is left untouched
+// and the moved from handle is only fit for destruction or assignment.
+// Assignment swaps the representations, so that the old representation
+// is released along with the argument.
 
 // concrete
 #define CONCRETE(PTR)               \
   PTR##_rep *rep;                   \
 public:                             \
   inline PTR (const PTR&);          \
+  inline PTR (PTR&&);               \
   inline ~PTR ();                   \
   inline PTR##_rep* operator -> (); \
   inline PTR& operator = (PTR x)
-#define CONCRETE_CODE(PTR)                       \
-  inline PTR::PTR (const PTR& x):                \
-    rep(x.rep) { INC_COUNT (this->rep); }        \
-  inline PTR::~PTR () { DEC_COUNT (this->rep); } \
-  inline PTR##_rep* PTR::operator -> () {        \
-    return rep; }                                \
-  inline PTR& PTR::operator = (PTR x) {          \
-    INC_COUNT (x.rep); DEC_COUNT (this->rep);    \
-    this->rep=x.rep; return *this; }
+#define CONCRETE_CODE(PTR)                            \
+  inline PTR::PTR (const PTR& x):                     \
+    rep(x.rep) { INC_COUNT (this->rep); }             \
+  inline PTR::PTR (PTR&& x):                          \
+    rep(x.rep) { x.rep= NULL; }                       \
+  inline PTR::~PTR () { DEC_COUNT_NULL (this->rep); } \
+  inline PTR##_rep* PTR::operator -> () {             \
+    return rep; }                                     \
+  inline PTR& PTR::operator = (PTR x) {               \
+    PTR##_rep* old= this->rep; this->rep= x.rep;      \
+    x.rep= old; return *this; }
 
 // definition for 1 parameter template classes
 #define CONCRETE_TEMPLATE(PTR,T)      \
   PTR##_rep<T> *rep;                  \
 public:                               \
   inline PTR (const PTR<T>&);         \
+  inline PTR (PTR<T>&&);              \
   inline ~PTR ();                     \
   inline PTR##_rep<T>* operator -> (); \
   inline PTR<T>& operator = (PTR<T> x)
-#define CONCRETE_TEMPLATE_CODE(PTR,TT,T)                          \
-  template<TT T> inline PTR<T>::PTR (const PTR<T>& x):            \
-    rep(x.rep) { INC_COUNT (this->rep); }                         \
-  template<TT T> inline PTR<T>::~PTR() { DEC_COUNT (this->rep); } \
-  template<TT T> inline PTR##_rep<T>* PTR<T>::operator -> () {    \
-    return this->rep; }                                           \
-  template<TT T> inline PTR<T>& PTR<T>::operator = (PTR<T> x) {   \
-    INC_COUNT (x.rep); DEC_COUNT (this->rep);                     \
-    this->rep=x.rep; return *this; }
+#define CONCRETE_TEMPLATE_CODE(PTR,TT,T)                               \
+  template<TT T> inline PTR<T>::PTR (const PTR<T>& x):                 \
+    rep(x.rep) { INC_COUNT (this->rep); }                              \
+  template<TT T> inline PTR<T>::PTR (PTR<T>&& x):                      \
+    rep(x.rep) { x.rep= NULL; }                                        \
+  template<TT T> inline PTR<T>::~PTR() { DEC_COUNT_NULL (this->rep); } \
+  template<TT T> inline PTR##_rep<T>* PTR<T>::operator -> () {         \
+    return this->rep; }                                                \
+  template<TT T> inline PTR<T>& PTR<T>::operator = (PTR<T> x) {        \
+    PTR##_rep<T>* old= this->rep; this->rep= x.rep;                    \
+    x.rep= old; return *this; }
 
 // definition for 2 parameter template classes
 #define CONCRETE_TEMPLATE_2(PTR,T1,T2)     \
   PTR##_rep<T1,T2> *rep;                   \
 public:                                    \
   inline PTR (const PTR<T1,T2>&);          \
+  inline PTR (PTR<T1,T2>&&);               \
   inline ~PTR ();                          \
   inline PTR##_rep<T1,T2>* operator -> (); \
   inline PTR<T1,T2>& operator = (PTR<T1,T2> x)
 #define CONCRETE_TEMPLATE_2_CODE(PTR,TT1,T1,TT2,T2)                           \
   template<TT1 T1,TT2 T2> inline PTR<T1,T2>::PTR (const PTR<T1,T2>& x):       \
     rep(x.rep) { INC_COUNT (this->rep); }                                     \
-  template<TT1 T1,TT2 T2> inline PTR<T1,T2>::~PTR () { DEC_COUNT(this->rep);} \
+  template<TT1 T1,TT2 T2> inline PTR<T1,T2>::PTR (PTR<T1,T2>&& x):            \
+    rep(x.rep) { x.rep= NULL; }                                               \
+  template<TT1 T1,TT2 T2> inline PTR<T1,T2>::~PTR () {                        \
+    DEC_COUNT_NULL (this->rep); }                                             \
   template<TT1 T1,TT2 T2> inline PTR##_rep<T1,T2>* PTR<T1,T2>::operator -> () \
     { return this->rep; }                                                     \
   template <TT1 T1,TT2 T2>                                                    \
   inline PTR<T1,T2>& PTR<T1,T2>::operator = (PTR<T1,T2> x) {                  \
-    INC_COUNT (x.rep); DEC_COUNT (this->rep);                                 \
-    this->rep=x.rep; return *this; }
+    PTR##_rep<T1,T2>* old= this->rep; this->rep= x.rep;                       \
+    x.rep= old; return *this; }
 // end concrete
 
 // abstract
@@ -285,12 +334,14 @@ public:                                    \
   inline PTR::PTR (): rep(NULL) {}                      \
   inline PTR::PTR (const PTR& x):                       \
     rep(x.rep) { INC_COUNT_NULL (this->rep); }          \
+  inline PTR::PTR (PTR&& x):                            \
+    rep(x.rep) { x.rep= NULL; }                         \
   inline PTR::~PTR() { DEC_COUNT_NULL (this->rep); }    \
   inline PTR##_rep* PTR::operator -> () {               \
     return this->rep; }                                 \
   inline PTR& PTR::operator = (PTR x) {                 \
-    INC_COUNT_NULL (x.rep); DEC_COUNT_NULL (this->rep); \
-    this->rep=x.rep; return *this; }                    \
+    PTR##_rep* old= this->rep; this->rep= x.rep;        \
+    x.rep= old; return *this; }                         \
   inline bool is_nil (PTR x) { return x.rep==NULL; }
 #define CONCRETE_NULL_TEMPLATE(PTR,T) \
   CONCRETE_TEMPLATE(PTR,T);           \
@@ -300,12 +351,14 @@ public:                                    \
   template<TT T> inline PTR<T>::PTR (): rep(NULL) {}                    \
   template<TT T> inline PTR<T>::PTR (const PTR<T>& x):                  \
     rep(x.rep) { INC_COUNT_NULL (this->rep); }                          \
+  template<TT T> inline PTR<T>::PTR (PTR<T>&& x):                       \
+    rep(x.rep) { x.rep= NULL; }                                         \
   template<TT T> inline PTR<T>::~PTR () { DEC_COUNT_NULL (this->rep); } \
   template<TT T> inline PTR##_rep<T>* PTR<T>::operator -> () {          \
     return this->rep; }                                                 \
   template<TT T> inline PTR<T>& PTR<T>::operator = (PTR<T> x) {         \
-    INC_COUNT_NULL (x.rep); DEC_COUNT_NULL (this->rep);                 \
-    this->rep=x.rep; return *this; }                                    \
+    PTR##_rep<T>* old= this->rep; this->rep= x.rep;                     \
+    x.rep= old; return *this; }                                         \
   template<TT T> inline bool is_nil (PTR<T> x) { return x.rep==NULL; }
 
 #define CONCRETE_NULL_TEMPLATE_2(PTR,T1,T2) \
@@ -316,14 +369,16 @@ public:                                    \
   template<TT1 T1, TT2 T2> inline PTR<T1,T2>::PTR (): rep(NULL) {}        \
   template<TT1 T1, TT2 T2> inline PTR<T1,T2>::PTR (const PTR<T1,T2>& x):  \
     rep(x.rep) { INC_COUNT_NULL (this->rep); }                            \
+  template<TT1 T1, TT2 T2> inline PTR<T1,T2>::PTR (PTR<T1,T2>&& x):       \
+    rep(x.rep) { x.rep= NULL; }                                           \
   template<TT1 T1, TT2 T2> inline PTR<T1,T2>::~PTR () {                   \
     DEC_COUNT_NULL (this->rep); }                                         \
   template<TT1 T1, TT2 T2> PTR##_rep<T1,T2>* PTR<T1,T2>::operator -> () { \
     return this->rep; }                                                   \
   template<TT1 T1, TT2 T2>                                                \
   inline PTR<T1,T2>& PTR<T1,T2>::operator = (PTR<T1,T2> x) {              \
-    INC_COUNT_NULL (x.rep); DEC_COUNT_NULL (this->rep);                   \
-    this->rep=x.rep; return *this; }                                      \
+    PTR##_rep<T1,T2>* old= this->rep; this->rep= x.rep;                   \
+    x.rep= old; return *this; }                                           \
   template<TT1 T1, TT2 T2> inline bool is_nil (PTR<T1,T2> x) {               \
     return x.rep==NULL; }
 // end concrete_null
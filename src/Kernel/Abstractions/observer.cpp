@@ -386,6 +386,26 @@ busy_tree (tree& ref) {
   else return true;
 }
 
+static bool
+modifies_interned (tree t, modification mod) {
+  // Would mod alter an interned (and thus immutable) tree inside t?
+  path p= root (mod);
+  while (!is_nil (p)) {
+    if (is_interned (t)) return true;
+    t= t[p->item];
+    p= p->next;
+  }
+  switch (mod->k) {
+  case MOD_ASSIGN:
+  case MOD_INSERT_NODE:
+  case MOD_REMOVE_NODE:
+  case MOD_SET_CURSOR:
+    return false;  // the subtree at the root is replaced, not modified
+  default:
+    return is_interned (t);
+  }
+}
+
 void
 apply (tree& ref, modification mod) {
   if (!is_applicable (ref, mod)) {
@@ -393,6 +413,10 @@ apply (tree& ref, modification mod) {
     failed_error << "ref= " << ref << "\n";
     FAILED ("invalid modification");
   }
+  if (modifies_interned (ref, mod)) {
+    failed_error << "mod= " << mod << "\n";
+    FAILED ("modification of an interned tree");
+  }
   path ip= obtain_ip (ref);
   path rp= reverse (ip);
   path p = rp * root (mod);
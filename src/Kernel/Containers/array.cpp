@@ -38,7 +38,7 @@ array_rep<T>::resize (int m) {
     if (mm != 0) {
       int i, k= (m<n? m: n);
       T* b= tm_new_array<T> (mm);
-      for (i=0; i<k; i++) b[i]= a[i];
+      for (i=0; i<k; i++) b[i]= std::move (a[i]);
       if (nn != 0) tm_delete_array (a);
       a= b;
     }
@@ -130,7 +130,7 @@ operator << (tm_ostream& out, array<T> a) {
 template<class T> array<T>&
 operator << (array<T>& a, T x) {
   a->resize (N(a)+ 1);
-  a[N(a)-1]=x;
+  a[N(a)-1]= std::move (x);
   return a;
 }
 
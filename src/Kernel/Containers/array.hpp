@@ -19,6 +19,7 @@ template<class T> class array;
 template<class T> int N (array<T> a);
 template<class T> T*  A (array<T> a);
 template<class T> array<T> copy (array<T> x);
+template<class T> void share (array<T> a);
 
 template<class T> class array_rep: concrete_struct {
   int n;
@@ -33,6 +34,7 @@ public:
   friend int N LESSGTR (array<T> a);
   friend T*  A LESSGTR (array<T> a);
   friend array<T> copy LESSGTR (array<T> a);
+  friend void share LESSGTR (array<T> a);
 };
 
 template<class T> class array {
@@ -45,6 +47,7 @@ template<class T> class array {
   array (T x1, T x2, T x3, T x4, T x5);
   inline T& operator [] (int i) { return rep->a[i]; }
   operator tree (); // defined in tree.hpp
+  friend void share LESSGTR (array<T> a);
 };
 CONCRETE_TEMPLATE_CODE(array,class,T);
 
@@ -53,6 +56,9 @@ TMPL inline int N (array<T> a) { return a->n; }
 TMPL inline T*  A (array<T> a) { return a->a; }
 TMPL inline array<T> copy (array<T> a) {
   return array<T> (a->a, a->n); }
+TMPL inline void share (array<T> a) {
+  // only the array itself; the entries have to be shared separately
+  REF_SHARE (a.rep); }
 TMPL tm_ostream& operator << (tm_ostream& out, array<T> a);
 TMPL array<T>& operator << (array<T>& a, T x);
 TMPL array<T>& operator << (array<T>& a, array<T> b);
@@ -0,0 +1,104 @@
+
+/******************************************************************************
+* MODULE     : char_table.cpp
+* DESCRIPTION: tables indexed by character codes with reference counting
+* COPYRIGHT  : (C) 2026  Massimiliano Gubinelli
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#ifndef CHAR_TABLE_CC
+#define CHAR_TABLE_CC
+#include "char_table.hpp"
+
+/******************************************************************************
+* Pages
+******************************************************************************/
+
+template<class T>
+char_table_page<T>::char_table_page (T init) {
+  for (int i=0; i<256; i++) {
+    item[i]= init;
+    defined[i]= false;
+  }
+}
+
+template<class T>
+char_table_rep<T>::~char_table_rep () {
+  if (pages == NULL) return;
+  for (int i=0; i<CHAR_TABLE_PAGES; i++)
+    if (pages[i] != NULL) tm_delete (pages[i]);
+  tm_delete_array (pages);
+}
+
+template<class T> char_table_page<T>*
+char_table_rep<T>::define (int c) {
+  if (pages == NULL) {
+    pages= tm_new_array<char_table_page<T>*> (CHAR_TABLE_PAGES);
+    for (int i=0; i<CHAR_TABLE_PAGES; i++) pages[i]= NULL;
+  }
+  char_table_page<T>*& p= pages[c >> 8];
+  if (p == NULL) p= tm_new<char_table_page<T> > (init);
+  p->defined[c & 255]= true;
+  size++;
+  return p;
+}
+
+template<class T> void
+char_table_rep<T>::reset (int c) {
+  if (((unsigned int) c) >= CHAR_TABLE_RANGE) extra->reset (c);
+  else if (contains (c)) {
+    char_table_page<T>* p= page (c);
+    p->item[c & 255]= init;
+    p->defined[c & 255]= false;
+    size--;
+  }
+}
+
+/******************************************************************************
+* Iteration over the defined codes
+******************************************************************************/
+
+template<class T>
+class char_table_iterator_rep: public iterator_rep<int> {
+  char_table<T> t;
+  int c;
+  iterator<int> it;
+  void spool ();
+
+public:
+  char_table_iterator_rep (char_table<T> t2):
+    t (t2), c (0), it (iterate (t2->extra)) {}
+  bool busy ();
+  int next ();
+};
+
+template<class T> void
+char_table_iterator_rep<T>::spool () {
+  while (c < CHAR_TABLE_RANGE && !t->contains (c)) {
+    if (t->page (c) == NULL) c= (c | 255) + 1;
+    else c++;
+  }
+}
+
+template<class T> bool
+char_table_iterator_rep<T>::busy () {
+  spool ();
+  return c < CHAR_TABLE_RANGE || it->busy ();
+}
+
+template<class T> int
+char_table_iterator_rep<T>::next () {
+  ASSERT (busy (), "end of iterator");
+  if (c < CHAR_TABLE_RANGE) return c++;
+  return it->next ();
+}
+
+template<class T> iterator<int>
+iterate (char_table<T> t) {
+  return tm_new<char_table_iterator_rep<T> > (t);
+}
+
+#endif // defined CHAR_TABLE_CC
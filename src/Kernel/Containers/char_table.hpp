@@ -0,0 +1,87 @@
+
+/******************************************************************************
+* MODULE     : char_table.hpp
+* DESCRIPTION: tables indexed by character codes with reference counting
+* COPYRIGHT  : (C) 2026  Massimiliano Gubinelli
+*******************************************************************************
+* The codes 0, ..., 0xffff are stored in pages of 256 entries, which are
+* only allocated when one of their entries is defined.  Fonts mostly use
+* a few contiguous blocks of such codes, so that a lookup amounts to two
+* array accesses.  Other codes are stored in a hashmap.
+*******************************************************************************
+* This software falls under the GNU general public license version 3 or later.
+* It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+* in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+******************************************************************************/
+
+#ifndef CHAR_TABLE_H
+#define CHAR_TABLE_H
+#include "hashmap.hpp"
+#include "iterator.hpp"
+
+#define CHAR_TABLE_PAGES 256
+#define CHAR_TABLE_RANGE (CHAR_TABLE_PAGES << 8)
+
+template<class T> class char_table;
+template<class T> class char_table_iterator_rep;
+template<class T> int N (char_table<T> t);
+template<class T> iterator<int> iterate (char_table<T> t);
+
+template<class T> struct char_table_page {
+  T    item[256];
+  bool defined[256];
+  char_table_page (T init);
+};
+
+template<class T> class char_table_rep: concrete_struct {
+  int size;                    // nr of entries in the pages
+  T   init;                    // default entry
+  char_table_page<T>** pages;  // the pages, or NULL if none was allocated
+  hashmap<int,T> extra;        // the entries for the other codes
+
+public:
+  inline char_table_rep (T init2):
+    size (0), init (init2), pages (NULL), extra (init2) {}
+  ~char_table_rep ();
+
+  inline char_table_page<T>* page (int c) {
+    return pages == NULL? (char_table_page<T>*) NULL: pages[c >> 8]; }
+  inline bool contains (int c) {
+    if (((unsigned int) c) >= CHAR_TABLE_RANGE) return extra->contains (c);
+    char_table_page<T>* p= page (c);
+    return p != NULL && p->defined[c & 255]; }
+  inline T bracket_ro (int c) {
+    if (((unsigned int) c) >= CHAR_TABLE_RANGE) return extra[c];
+    char_table_page<T>* p= page (c);
+    return p == NULL? init: p->item[c & 255]; }
+  inline T& bracket_rw (int c) {
+    if (((unsigned int) c) >= CHAR_TABLE_RANGE) return extra (c);
+    char_table_page<T>* p= page (c);
+    if (p == NULL || !p->defined[c & 255]) p= define (c);
+    return p->item[c & 255]; }
+  char_table_page<T>* define (int c);
+  void reset (int c);
+
+  friend class char_table<T>;
+  friend class char_table_iterator_rep<T>;
+  friend int N LESSGTR (char_table<T> t);
+  friend iterator<int> iterate LESSGTR (char_table<T> t);
+};
+
+template<class T> class char_table {
+CONCRETE_TEMPLATE(char_table,T);
+  inline char_table (T init):
+    rep (tm_new<char_table_rep<T> > (init)) {}
+  inline T  operator [] (int c) { return rep->bracket_ro (c); }
+  inline T& operator () (int c) { return rep->bracket_rw (c); }
+};
+CONCRETE_TEMPLATE_CODE(char_table,class,T);
+
+template<class T> inline int
+N (char_table<T> t) {
+  return t->size + N (t->extra);
+}
+
+#include "char_table.cpp"
+
+#endif // defined CHAR_TABLE_H
@@ -12,15 +12,18 @@
 #ifndef HASHMAP_CC
 #define HASHMAP_CC
 #include "hashmap.hpp"
+#include <new>
 #define TMPL template<class T, class U>
 #define H hashentry<T,U>
 
+TMPL unsigned int hashmap_rep<T,U>::stamps= 0;
+
 /******************************************************************************
 * Hashmap entries
 ******************************************************************************/
 
 TMPL H::hashentry (int code2, T key2, U im2):
-  code (code2), key (key2), im (im2) {}
+  code (code2), key (std::move (key2)), im (std::move (im2)) {}
 
 TMPL H::operator tree () {
   return tree (ASSOCIATE, as_tree(key), as_tree(im)); }
@@ -41,8 +44,10 @@ operator != (H h1, H h2) {
   return (h1.code!=h2.code) || (h1.key!=h2.key) || (h1.im!=h2.im);
 }
 
+#ifdef CHAINED_HASHMAP
+
 /******************************************************************************
-* Routines for hashmaps
+* Routines for hashmaps with chained buckets
 ******************************************************************************/
 
 TMPL void
@@ -51,6 +56,7 @@ hashmap_rep<T,U>::resize (int n2) {
   int oldn= n;
   list<hashentry<T,U> >* olda= a;
   n= n2;
+  stamp= ++stamps;
   a= tm_new_array<list<hashentry<T,U> > > (n);
   for (i=0; i<oldn; i++) {
     list<hashentry<T,U> > l(olda[i]);
@@ -75,11 +81,6 @@ hashmap_rep<T,U>::contains (T x) {
   return false;
 }
 
-TMPL bool
-hashmap_rep<T,U>::empty () {
-  return size==0;
-}
-
 TMPL U&
 hashmap_rep<T,U>::bracket_rw (T x) {
   int hv= hash (x);
@@ -108,6 +109,18 @@ hashmap_rep<T,U>::bracket_ro (T x) {
   return init;
 }
 
+TMPL U*
+hashmap_rep<T,U>::locate (T x) {
+  int hv= hash (x);
+  list<hashentry<T,U> >  l (a [hv & (n-1)]);
+  while (!is_nil (l)) {
+    if (l->item.code == hv && l->item.key == x)
+      return &(l->item.im);
+    l= l->next;
+  }
+  return NULL;
+}
+
 TMPL void
 hashmap_rep<T,U>::reset (T x) {
   int hv= hash (x);
@@ -115,6 +128,7 @@ hashmap_rep<T,U>::reset (T x) {
   while (!is_nil (*l)) {
     if ((*l)->item.code == hv && (*l)->item.key == x) {
       *l= (*l)->next;
+      stamp= ++stamps;
       size --;
       if (size < (n>>1) * max) resize (n>>1);
       return;
@@ -123,63 +137,190 @@ hashmap_rep<T,U>::reset (T x) {
   }
 }
 
+#else // CHAINED_HASHMAP
+
+/******************************************************************************
+* Routines for hashmaps with open addressing
+******************************************************************************/
+
 TMPL void
-hashmap_rep<T,U>::generate (void (*routine) (T)) {
+hashmap_rep<T,U>::allocate (int n2) {
   int i;
-  for (i=0; i<n; i++) {
-    list<hashentry<T,U> > l (a[i]);
-    while (!is_nil (l)) {
-      routine (l->item.key);
-      l=l->next;
+  n= 1;
+  while (n < n2) n <<= 1;
+  deleted= 0;
+  ctrl= tm_new_array<signed char> (n);
+  for (i=0; i<n; i++) ctrl[i]= HASHMAP_EMPTY;
+  a= (hashentry<T,U>*) fast_alloc (n * sizeof (hashentry<T,U>));
+}
+
+TMPL void
+hashmap_rep<T,U>::release () {
+  int i;
+  for (i=0; i<n; i++)
+    if (ctrl[i] >= 0) a[i].~H ();
+  fast_free ((void*) a, n * sizeof (hashentry<T,U>));
+  tm_delete_array (ctrl);
+}
+
+TMPL void
+hashmap_rep<T,U>::resize (int n2) {
+  int i, oldn= n;
+  signed char* oldctrl= ctrl;
+  hashentry<T,U>* olda= a;
+  allocate (n2);
+  stamp= ++stamps;
+  for (i=0; i<oldn; i++)
+    if (oldctrl[i] >= 0) {
+      unsigned int m= hashmap_mix (olda[i].code);
+      int j= m & (n-1);
+      while (ctrl[j] != HASHMAP_EMPTY) j= (j+1) & (n-1);
+      ctrl[j]= (signed char) (m >> 25);
+      (void) new ((void*) (a+j)) H (std::move (olda[i]));
+      olda[i].~H ();
+    }
+  fast_free ((void*) olda, oldn * sizeof (hashentry<T,U>));
+  tm_delete_array (oldctrl);
+}
+
+TMPL bool
+hashmap_rep<T,U>::contains (T x) {
+  int hv= hash (x);
+  unsigned int m= hashmap_mix (hv);
+  signed char c= (signed char) (m >> 25);
+  int i= m & (n-1);
+  while (ctrl[i] != HASHMAP_EMPTY) {
+    if (ctrl[i] == c && a[i].code == hv && a[i].key == x) return true;
+    i= (i+1) & (n-1);
+  }
+  return false;
+}
+
+TMPL U&
+hashmap_rep<T,U>::bracket_rw (T x) {
+  int hv= hash (x);
+  unsigned int m= hashmap_mix (hv);
+  signed char c= (signed char) (m >> 25);
+  int i= m & (n-1), free= -1;
+  while (ctrl[i] != HASHMAP_EMPTY) {
+    if (ctrl[i] == c && a[i].code == hv && a[i].key == x) return a[i].im;
+    if (free < 0 && ctrl[i] == HASHMAP_DELETED) free= i;
+    i= (i+1) & (n-1);
+  }
+  if (free >= 0) {
+    i= free;
+    deleted--;
+  }
+  else if ((size + deleted + 1) << 3 > n * 7) {
+    // the table is full: grow it, or only remove the deleted slots
+    resize ((size + 1) << 4 > n * 7? (n << 1): n);
+    i= m & (n-1);
+    while (ctrl[i] != HASHMAP_EMPTY) i= (i+1) & (n-1);
+  }
+  ctrl[i]= c;
+  (void) new ((void*) (a+i)) H (hv, x, init);
+  size ++;
+  return a[i].im;
+}
+
+TMPL U
+hashmap_rep<T,U>::bracket_ro (T x) {
+  int hv= hash (x);
+  unsigned int m= hashmap_mix (hv);
+  signed char c= (signed char) (m >> 25);
+  int i= m & (n-1);
+  while (ctrl[i] != HASHMAP_EMPTY) {
+    if (ctrl[i] == c && a[i].code == hv && a[i].key == x) return a[i].im;
+    i= (i+1) & (n-1);
+  }
+  return init;
+}
+
+TMPL U*
+hashmap_rep<T,U>::locate (T x) {
+  int hv= hash (x);
+  unsigned int m= hashmap_mix (hv);
+  signed char c= (signed char) (m >> 25);
+  int i= m & (n-1);
+  while (ctrl[i] != HASHMAP_EMPTY) {
+    if (ctrl[i] == c && a[i].code == hv && a[i].key == x) return &(a[i].im);
+    i= (i+1) & (n-1);
+  }
+  return NULL;
+}
+
+TMPL void
+hashmap_rep<T,U>::reset (T x) {
+  int hv= hash (x);
+  unsigned int m= hashmap_mix (hv);
+  signed char c= (signed char) (m >> 25);
+  int i= m & (n-1);
+  while (ctrl[i] != HASHMAP_EMPTY) {
+    if (ctrl[i] == c && a[i].code == hv && a[i].key == x) {
+      a[i].~H ();
+      stamp= ++stamps;
+      // a slot before an empty one does not interrupt any probe sequence
+      if (ctrl[(i+1) & (n-1)] == HASHMAP_EMPTY) ctrl[i]= HASHMAP_EMPTY;
+      else {
+        ctrl[i]= HASHMAP_DELETED;
+        deleted++;
+      }
+      size --;
+      if (n > 8 && (size << 3) < n) resize (n >> 1);
+      return;
     }
+    i= (i+1) & (n-1);
   }
 }
 
+#endif // CHAINED_HASHMAP
+
+/******************************************************************************
+* Routines which do not depend on the representation
+******************************************************************************/
+
+TMPL bool
+hashmap_rep<T,U>::empty () {
+  return size==0;
+}
+
+TMPL void
+hashmap_rep<T,U>::generate (void (*routine) (T)) {
+  for (hashmap_entries<T,U> e (this); e.busy (); e.next ())
+    routine (e->key);
+}
+
 TMPL tm_ostream&
 operator << (tm_ostream& out, hashmap<T,U> h) {
-  int i= 0, j= 0, n= h->n, size= h->size;
+  int j= 0, size= h->size;
   out << "{ ";
-  for (; i<n; i++) {
-    list<hashentry<T,U> > l= h->a[i];
-    for (; !is_nil (l); l= l->next, j++) {
-      out << l->item;
-      if (j != size-1) out << ", ";
-    }
+  for (hashmap_entries<T,U> e (h); e.busy (); e.next (), j++) {
+    out << *e;
+    if (j != size-1) out << ", ";
   }
   out << " }";
   return out;
 }
 
 TMPL hashmap<T,U>::operator tree () {
-  int i=0, j=0, n=rep->n, size=rep->size;
+  int j=0, size=rep->size;
   tree t (COLLECTION, size);
-  for (; i<n; i++) {
-    list<hashentry<T,U> > l= rep->a[i];
-    for (; !is_nil (l); l= l->next, j++)
-      t[j]= (tree) l->item;
-  }
+  for (hashmap_entries<T,U> e (rep); e.busy (); e.next (), j++)
+    t[j]= (tree) *e;
   return t;
 }
 
 TMPL void
 hashmap_rep<T,U>::join (hashmap<T,U> h) {
-  int i= 0, n= h->n;
-  for (; i<n; i++) {
-    list<hashentry<T,U> > l= h->a[i];
-    for (; !is_nil(l); l= l->next)
-      bracket_rw (l->item.key)= copy (l->item.im);
-  }
+  for (hashmap_entries<T,U> e (h); e.busy (); e.next ())
+    bracket_rw (e->key)= copy (e->im);
 }
 
 TMPL bool
 operator == (hashmap<T,U> h1, hashmap<T,U> h2) {
   if (h1->size != h2->size) return false;
-  int i= 0, n= h1->n;
-  for (; i<n; i++) {
-    list<hashentry<T,U> > l= h1->a[i];
-    for (; !is_nil(l); l=l->next)
-      if (h2[l->item.key] != l->item.im) return false;
-  }
+  for (hashmap_entries<T,U> e (h1); e.busy (); e.next ())
+    if (h2[e->key] != e->im) return false;
   return true;
 }
 
@@ -19,6 +19,7 @@ template<class T,class U> class hashmap;
 template<class T,class U> class rel_hashmap;
 template<class T,class U> class rel_hashmap_rep;
 template<class T,class U> class hashmap_iterator_rep;
+template<class T,class U> class hashmap_entries;
 
 template<class T,class U> int N (hashmap<T,U> a);
 template<class T,class U> tm_ostream& operator << (tm_ostream& out, hashmap<T,U> h);
@@ -37,18 +38,53 @@ template<class T, class U> struct hashentry {
   operator tree ();
 };
 
+/******************************************************************************
+* By default, the entries are stored in a flat table with open addressing:
+* each slot has a control byte which is either HASHMAP_EMPTY, HASHMAP_DELETED
+* or seven bits of the mixed hash code of the key in the slot, so that most
+* failed comparisons are decided without touching the entries themselves.
+* Collisions are resolved by linear probing.  Entries only move when the
+* table is resized, exactly as for the former implementation with chained
+* buckets, which remains available through the CHAINED_HASHMAP option.
+******************************************************************************/
+
+#define HASHMAP_EMPTY   ((signed char) -128)
+#define HASHMAP_DELETED ((signed char) -2)
+
+inline unsigned int
+hashmap_mix (int hv) {
+  return (unsigned int) ((((DN) (unsigned int) hv) * 0x9E3779B97F4A7C15ULL)
+                         >> 32);
+}
+
 template<class T, class U> class hashmap_rep: concrete_struct {
   int size;                  // size of hashmap (nr of entries)
   int n;                     // nr of keys (a power of two)
   int max;                   // mean number of entries per key
   U   init;                  // default entry
+  unsigned int stamp;        // changes whenever entries move or are removed
+  static unsigned int stamps;
+#ifdef CHAINED_HASHMAP
   list<hashentry<T,U> >* a;  // the array of entries
+#else
+  int deleted;               // nr of deleted slots
+  signed char* ctrl;         // the control bytes of the slots
+  hashentry<T,U>* a;         // the slots (only constructed when in use)
+  void allocate (int n);
+  void release ();
+#endif
 
 public:
+#ifdef CHAINED_HASHMAP
   inline hashmap_rep<T,U>(U init2, int n2=1, int max2=1):
-    size(0), n(n2), max(max2), init(init2),
+    size(0), n(n2), max(max2), init(init2), stamp(++stamps),
     a(tm_new_array<list<hashentry<T,U> > > (n)) {}
   inline ~hashmap_rep<T,U> () { tm_delete_array (a); }
+#else
+  inline hashmap_rep<T,U>(U init2, int n2=1, int max2=1):
+    size(0), n(0), max(max2), init(init2), stamp(++stamps) { allocate (n2); }
+  inline ~hashmap_rep<T,U> () { release (); }
+#endif
   void resize (int n);
   void reset (T x);
   void generate (void (*routine) (T));
@@ -56,10 +92,12 @@ public:
   bool empty ();
   U    bracket_ro (T x);
   U&   bracket_rw (T x);
+  U*   locate (T x);
   U&   bracket_rw_debug (T x);
   void join (hashmap<T,U> H);
 
   friend class hashmap<T,U>;
+  friend class hashmap_entries<T,U>;
   friend class rel_hashmap<T,U>;
   friend class rel_hashmap_rep<T,U>;
   friend class hashmap_iterator_rep<T,U>;
@@ -96,6 +134,38 @@ CONCRETE_TEMPLATE_2(hashmap,T,U);
 };
 CONCRETE_TEMPLATE_2_CODE(hashmap,class,T,class,U);
 
+template<class T, class U> class hashmap_entries {
+  // visits the entries of a hashmap, whatever its representation;
+  // the hashmap must be kept alive by the caller
+  hashmap_rep<T,U>* h;
+  int i;
+#ifdef CHAINED_HASHMAP
+  list<hashentry<T,U> > l;
+  inline void spool () {
+    while (is_nil (l) && (++i) < h->n) l= h->a[i]; }
+public:
+  inline hashmap_entries (hashmap_rep<T,U>* h2):
+    h (h2), i (0), l (h2->a[0]) { spool (); }
+  inline hashmap_entries (hashmap<T,U> h2):
+    h (h2.operator -> ()), i (0), l (h2->a[0]) { spool (); }
+  inline bool busy () { return i < h->n; }
+  inline void next () { l= l->next; spool (); }
+  inline hashentry<T,U>& operator * () { return l->item; }
+  inline hashentry<T,U>* operator -> () { return &(l->item); }
+#else
+  inline void spool () {
+    while (i < h->n && h->ctrl[i] < 0) i++; }
+public:
+  inline hashmap_entries (hashmap_rep<T,U>* h2): h (h2), i (0) { spool (); }
+  inline hashmap_entries (hashmap<T,U> h2):
+    h (h2.operator -> ()), i (0) { spool (); }
+  inline bool busy () { return i < h->n; }
+  inline void next () { i++; spool (); }
+  inline hashentry<T,U>& operator * () { return h->a[i]; }
+  inline hashentry<T,U>* operator -> () { return h->a + i; }
+#endif
+};
+
 #define TMPL template<class T, class U>
 TMPL inline int N (hashmap<T,U> h) { return h->size; }
 TMPL hashmap<T,U> changes (hashmap<T,U> patch, hashmap<T,U> base);
@@ -17,57 +17,32 @@
 
 TMPL void
 hashmap_rep<T,U>::write_back (T x, hashmap<T,U> base) {
-  int hv= hash (x);
-  list<hashentry<T,U> > l (a [hv & (n-1)]);
-  while (!is_nil (l)) {
-    if (l->item.code == hv && l->item.key == x)
-      return;
-    l= l->next;
-  }
-  if (size >= n*max) resize (n<<1);
-  list<hashentry<T,U> >& rl= a[hv & (n-1)];
-  rl= list<hashentry<T,U> > (H (hv, x, init), rl);
-  size ++;
-
-  list<hashentry<T,U> > bl (base->a [hv & (base->n-1)]);
-  while (!is_nil (bl)) {
-    if (bl->item.code == hv && bl->item.key == x) {
-      rl->item.im= bl->item.im;
-      return;
-    }
-    bl= bl->next;
-  }
-  rl->item.im= base->init;
+  if (contains (x)) return;
+  U y= base->bracket_ro (x);
+  bracket_rw (x)= y;
 }
 
 TMPL void
 hashmap_rep<T,U>::pre_patch (hashmap<T,U> patch, hashmap<T,U> base) {
-  int i= 0, n= patch->n;
-  for (; i<n; i++) {
-    list<hashentry<T,U> > l= patch->a[i];
-    for (; !is_nil (l); l= l->next) {
-      T x= l->item.key;
-      U y= contains (x)? bracket_ro (x): l->item.im;
-      if (base[x] == y) reset (x);
-      else bracket_rw (x)= y;
-    }
+  for (hashmap_entries<T,U> e (patch); e.busy (); e.next ()) {
+    T x= e->key;
+    U y= contains (x)? bracket_ro (x): e->im;
+    if (base[x] == y) reset (x);
+    else bracket_rw (x)= y;
   }
 }
 
 TMPL void
 hashmap_rep<T,U>::post_patch (hashmap<T,U> patch, hashmap<T,U> base) {
-  int i= 0, n= patch->n;
-  for (; i<n; i++) {
-    list<hashentry<T,U> > l= patch->a[i];
-    for (; !is_nil (l); l= l->next) {
-      T x= l->item.key;
-      U y= l->item.im;
-      if (base[x] == y) reset (x);
-      else bracket_rw (x)= y;
-    }
+  for (hashmap_entries<T,U> e (patch); e.busy (); e.next ()) {
+    T x= e->key;
+    U y= e->im;
+    if (base[x] == y) reset (x);
+    else bracket_rw (x)= y;
   }
 }
 
+#ifdef CHAINED_HASHMAP
 TMPL list<hashentry<T,U> >
 copy_list (list<hashentry<T,U> > l) {
   if (is_nil (l)) return l;
@@ -85,34 +60,36 @@ copy (hashmap<T,U> h) {
     h2->a[i]= copy_list (h->a[i]);
   return h2;
 }
+#else
+TMPL hashmap<T,U>
+copy (hashmap<T,U> h) {
+  int i, n= h->n;
+  hashmap<T,U> h2 (h->init, n, h->max);
+  h2->size= h->size;
+  h2->deleted= h->deleted;
+  for (i=0; i<n; i++) {
+    h2->ctrl[i]= h->ctrl[i];
+    if (h->ctrl[i] >= 0) (void) new ((void*) (h2->a+i)) H (h->a[i]);
+  }
+  return h2;
+}
+#endif
 
 TMPL hashmap<T,U>
 changes (hashmap<T,U> patch, hashmap<T,U> base) {
-  int i;
   hashmap<T,U> h (base->init);
-  for (i=0; i<patch->n; i++) {
-    list<hashentry<T,U> > l (patch->a[i]);
-    while (!is_nil (l)) {
-      if (l->item.im != base [l->item.key])
-	h (l->item.key)= l->item.im;
-      l=l->next;
-    }
-  }
+  for (hashmap_entries<T,U> e (patch); e.busy (); e.next ())
+    if (e->im != base [e->key])
+      h (e->key)= e->im;
   return h;
 }
 
 TMPL hashmap<T,U>
 invert (hashmap<T,U> patch, hashmap<T,U> base) {
-  int i;
   hashmap<T,U> h (base->init);
-  for (i=0; i<patch->n; i++) {
-    list<hashentry<T,U> > l (patch->a[i]);
-    while (!is_nil (l)) {
-      if (l->item.im != base [l->item.key])
-	h (l->item.key)= base [l->item.key];
-      l=l->next;
-    }
-  }
+  for (hashmap_entries<T,U> e (patch); e.busy (); e.next ())
+    if (e->im != base [e->key])
+      h (e->key)= base [e->key];
   return h;
 }
 
@@ -93,9 +93,7 @@ iterate (hashset<T> h) {
 template<class T, class U>
 class hashmap_iterator_rep: public iterator_rep<T> {
   hashmap<T,U> h;
-  int i;
-  list<hashentry<T,U> > l;
-  void spool ();
+  hashmap_entries<T,U> e;
 
 public:
   hashmap_iterator_rep (hashmap<T,U> h);
@@ -105,28 +103,18 @@ public:
 
 template<class T, class U>
 hashmap_iterator_rep<T,U>::hashmap_iterator_rep (hashmap<T,U> h2):
-  h (h2), i (0), l (h2->a[0]) {}
-
-template<class T, class U> void
-hashmap_iterator_rep<T,U>::spool () {
-  if (i >= h->n) return;
-  while (is_nil (l)) {
-    if ((++i) >= h->n) return;
-    l= h->a[i];
-  }
-}
+  h (h2), e (h2) {}
 
 template<class T, class U> bool
 hashmap_iterator_rep<T,U>::busy () {
-  spool ();
-  return i < h->n;
+  return e.busy ();
 }
 
 template<class T, class U> T
 hashmap_iterator_rep<T,U>::next () {
   ASSERT (busy (), "end of iterator");
-  T x (l->item.key);
-  l= l->next;
+  T x (e->key);
+  e.next ();
   return x;
 }
 
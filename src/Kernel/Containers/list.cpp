@@ -110,14 +110,17 @@ strong_equal (list<T> l1, list<T> l2) {
 
 template<class T> bool
 operator == (list<T> l1, list<T> l2) {
-  if (is_nil (l1) || is_nil (l2)) return (is_nil (l1) == is_nil (l2));
-  return (l1->item==l2->item) && (l1->next==l2->next);
+  // lists often share their tails, like the inverse paths of boxes
+  for (; !strong_equal (l1, l2); l1= l1->next, l2= l2->next) {
+    if (is_nil (l1) || is_nil (l2)) return false;
+    if (!(l1->item == l2->item)) return false;
+  }
+  return true;
 }
 
 template<class T> bool
 operator != (list<T> l1, list<T> l2) {
-  if (is_nil (l1) || is_nil (l2)) return (is_nil (l1) != is_nil (l2));
-  return (l1->item!=l2->item) || (l1->next!=l2->next);
+  return !(l1 == l2);
 }
 
 template<class T> bool
@@ -138,33 +141,59 @@ operator <= (list<T> l1, list<T> l2) {
 
 template<class T> int
 N (list<T> l) {
-  if (is_nil (l)) return 0;
-  else return N (l->next) + 1;
+  int n= 0;
+  for (; !is_nil (l); l= l->next) n++;
+  return n;
 }
 
+// The following routines build new lists from front to back, by keeping
+// a reference to the empty tail of the list under construction
+
 template<class T> list<T>
 copy (list<T> l) {
-  if (is_nil (l)) return list<T> ();
-  else return list<T> (l->item, copy (l->next));
+  list<T> r;
+  list<T>* t= &r;
+  for (; !is_nil (l); l= l->next) {
+    *t= list<T> (l->item);
+    t= &((*t)->next);
+  }
+  return r;
 }
 
 template<class T> list<T>
 operator * (list<T> l1, T x) {
-  if (is_nil (l1)) return x;
-  else return list<T> (l1->item, l1->next * x);
+  list<T> r;
+  list<T>* t= &r;
+  for (; !is_nil (l1); l1= l1->next) {
+    *t= list<T> (l1->item);
+    t= &((*t)->next);
+  }
+  *t= list<T> (x);
+  return r;
 }
 
 template<class T> list<T>
 operator * (list<T> l1, list<T> l2) {
-  if (is_nil (l1)) return copy (l2);
-  else return list<T> (l1->item, l1->next * l2);
+  list<T> r;
+  list<T>* t= &r;
+  for (; !is_nil (l1); l1= l1->next) {
+    *t= list<T> (l1->item);
+    t= &((*t)->next);
+  }
+  *t= copy (l2);
+  return r;
 }
 
 template<class T> list<T>
 head (list<T> l, int n) {
-  if (n==0) return list<T> ();
-  ASSERT (!is_nil (l), "list too short to get the head");
-  return list<T> (l->item, head (l->next, n-1));
+  list<T> r;
+  list<T>* t= &r;
+  for (; n>0; n--, l= l->next) {
+    ASSERT (!is_nil (l), "list too short to get the head");
+    *t= list<T> (l->item);
+    t= &((*t)->next);
+  }
+  return r;
 }
 
 template<class T> list<T>
@@ -20,6 +20,7 @@ template<class T> class list;
 template<class T> bool is_nil (list<T> l);
 template<class T> bool is_atom (list<T> l);
 template<class T> bool strong_equal (list<T> l1, list<T> l2);
+template<class T> void share (list<T> l);
 
 template<class T> class list {
   CONCRETE_NULL_TEMPLATE(list,T);
@@ -33,18 +34,26 @@ template<class T> class list {
 
   friend bool is_atom LESSGTR (list<T> l);
   friend bool strong_equal LESSGTR (list<T> l1, list<T> l2);
+  friend void share LESSGTR (list<T> l);
 };
 
+// List cells are among the most numerous objects (paths of cursors and
+// inverse paths of boxes), so they carry their own reference count
+// instead of deriving from concrete_struct, which saves a vtable pointer.
 extern int list_count;
-template<class T> class list_rep: concrete_struct {
+template<class T> class list_rep {
 public:
+  int     ref_count;
+  REF_SHARED_FIELD
   T       item;
   list<T> next;
 
-  inline list_rep<T> (T item2, list<T> next2): item(item2), next(next2) {
+  inline list_rep<T> (T item2, list<T> next2):
+    ref_count (1) REF_SHARED_INIT, item(item2), next(next2) {
     TM_DEBUG(list_count++); }
   inline ~list_rep<T> () { TM_DEBUG(list_count--); }
   friend class list<T>;
+  friend void share LESSGTR (list<T> l);
 };
 
 CONCRETE_NULL_TEMPLATE_CODE(list,class,T);
@@ -58,6 +67,9 @@ TMPL inline list<T>::list (T item1, T item2, T item3, list<T> next):
   rep (tm_new<list_rep<T> > (item1, list<T> (item2, item3, next))) {}
 TMPL inline bool is_atom (list<T> l) { return (!is_nil (l)) && is_nil (l->next); }
 TMPL list<T> list<T>::init= list<T> ();
+TMPL inline void share (list<T> l) {
+  // only the list cells; the items have to be shared separately
+  for (; l.rep != NULL; l= l.rep->next) REF_SHARE (l.rep); }
 
 TMPL int      N (list<T> l);
 TMPL list<T>  copy (list<T> l);
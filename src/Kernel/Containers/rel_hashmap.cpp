@@ -63,17 +63,11 @@ rel_hashmap_rep<T,U>::merge () {
 
 template <class T, class U> void
 rel_hashmap_rep<T,U>::find_changes (hashmap<T,U>& CH) {
-  int i;
   rel_hashmap<T,U> h (item, next);
   list<hashentry<T,U> > remove;
-  for (i=0; i<CH->n; i++) {
-    list<hashentry<T,U> > l (CH->a[i]);
-    while (!is_nil (l)) {
-      if (h [l->item.key] == l->item.im)
-	remove= list<hashentry<T,U> > (l->item, remove);
-      l=l->next;
-    }
-  }
+  for (hashmap_entries<T,U> e (CH); e.busy (); e.next ())
+    if (h [e->key] == e->im)
+      remove= list<hashentry<T,U> > (*e, remove);
   while (!is_nil (remove)) {
     CH->reset (remove->item.key);
     remove= remove->next;
@@ -82,16 +76,10 @@ rel_hashmap_rep<T,U>::find_changes (hashmap<T,U>& CH) {
 
 template <class T, class U> void
 rel_hashmap_rep<T,U>::find_differences (hashmap<T,U>& CH) {
-  int i;
   list<hashentry<T,U> > add;
-  for (i=0; i<item->n; i++) {
-    list<hashentry<T,U> > l (item->a[i]);
-    while (!is_nil (l)) {
-      if (!CH->contains (l->item.key))
-	add= list<hashentry<T,U> > (l->item, add);
-      l=l->next;
-    }
-  }
+  for (hashmap_entries<T,U> e (item); e.busy (); e.next ())
+    if (!CH->contains (e->key))
+      add= list<hashentry<T,U> > (*e, add);
   while (!is_nil (add)) {
     CH (add->item.key)= next [add->item.key];
     add= add->next;
@@ -101,14 +89,8 @@ rel_hashmap_rep<T,U>::find_differences (hashmap<T,U>& CH) {
 
 template <class T, class U> void
 rel_hashmap_rep<T,U>::change (hashmap<T,U> CH) {
-  int i;
-  for (i=0; i<CH->n; i++) {
-    list<hashentry<T,U> > l (CH->a[i]);
-    while (!is_nil (l)) {
-      item (l->item.key)= l->item.im;
-      l=l->next;
-    }
-  }
+  for (hashmap_entries<T,U> e (CH); e.busy (); e.next ())
+    item (e->key)= e->im;
 }
 
 template <class T, class U> tm_ostream&
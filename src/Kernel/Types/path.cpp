@@ -82,8 +82,13 @@ path_add (path p, int plus, int pos) {
 path
 path_up (path p) {
   ASSERT (!is_nil (p), "path is too short");
-  if (is_nil (p->next)) return path ();
-  return path (p->item, path_up (p->next));
+  path r;
+  path* t= &r;
+  for (; !is_nil (p->next); p= p->next) {
+    *t= path (p->item);
+    t= &((*t)->next);
+  }
+  return r;
 }
 
 path
@@ -28,22 +28,24 @@ round_length (int n) {
   return i;
 }
 
+static inline int
+heap_length (int n) {
+  return n <= STRING_INLINE? 0: round_length (n);
+}
+
 string_rep::string_rep (int n2):
-  n(n2), a ((n==0)?((char*) NULL):tm_new_array<char> (round_length(n))) {}
+  n(n2), a ((n<=STRING_INLINE)? b: tm_new_array<char> (round_length(n))) {}
 
 void
 string_rep::resize (int m) {
-  int nn= round_length (n);
-  int mm= round_length (m);
+  int nn= heap_length (n);
+  int mm= heap_length (m);
   if (mm != nn) {
-    if (mm != 0) {
-      int i, k= (m<n? m: n);
-      char* b= tm_new_array<char> (mm);
-      for (i=0; i<k; i++) b[i]= a[i];
-      if (nn != 0) tm_delete_array (a);
-      a= b;
-    }
-    else if (nn != 0) tm_delete_array (a);
+    int i, k= (m<n? m: n);
+    char* c= (mm == 0? b: tm_new_array<char> (mm));
+    for (i=0; i<k; i++) c[i]= a[i];
+    if (nn != 0) tm_delete_array (a);
+    a= c;
   }
   n= m;
 }
@@ -137,6 +139,11 @@ copy (string s) {
   return r;
 }
 
+void
+share (string s) {
+  REF_SHARE (s.rep);
+}
+
 string&
 operator << (string& a, char x) {
   a->resize (N(a)+ 1);
@@ -144,6 +151,14 @@ operator << (string& a, char x) {
   return a;
 }
 
+string&
+operator << (string& a, const char* b) {
+  int i, k1= N(a), k2= strlen (b);
+  a->resize (k1+k2);
+  for (i=0; i<k2; i++) a[i+k1]= b[i];
+  return a;
+}
+
 string&
 operator << (string& a, string b) {
   int i, k1= N(a), k2=N(b);
@@ -211,6 +226,25 @@ hash (string s) {
   return h;
 }
 
+/******************************************************************************
+* Slices
+******************************************************************************/
+
+string_slice
+slice (string s, int start, int end) {
+  start= max (min (N(s), start), 0);
+  end  = max (min (N(s), end), start);
+  return string_slice (s, start, end);
+}
+
+string&
+operator << (string& a, string_slice x) {
+  int i, k1= N(a), k2= N(x);
+  a->resize (k1+k2);
+  for (i=0; i<k2; i++) a[i+k1]= x[i];
+  return a;
+}
+
 /******************************************************************************
 * Conversion routines
 ******************************************************************************/
@@ -14,19 +14,25 @@
 #define STRING_H
 #include "basic.hpp"
 
+// Strings of at most STRING_INLINE characters are stored inside their
+// representation, so that they only require a single allocation.
+#define STRING_INLINE 8
+
 class string;
 class string_rep: concrete_struct {
   int n;
   char* a;
+  char b[STRING_INLINE];
 
 public:
-  inline string_rep (): n(0), a(NULL) {}
+  inline string_rep (): n(0), a(b) {}
          string_rep (int n);
-  inline ~string_rep () { if (n!=0) tm_delete_array (a); }
+  inline ~string_rep () { if (a!=b) tm_delete_array (a); }
   void resize (int n);
 
   friend class string;
   friend inline int N (string a);
+  friend void share (string s);
 };
 
 class string {
@@ -43,13 +49,16 @@ class string {
   bool operator == (string s);
   bool operator != (string s);
   string operator () (int start, int end);
+  friend void share (string s);
 };
 CONCRETE_CODE(string);
 
 extern inline int N (string a) { return a->n; }
 string   copy (string a);
+void     share (string s);
 tm_ostream& operator << (tm_ostream& out, string a);
 string&  operator << (string& a, char);
+string&  operator << (string& a, const char* b);
 string&  operator << (string& a, string b);
 string   operator * (const char* a, string b);
 string   operator * (string a, string b);
@@ -83,6 +92,26 @@ bool  is_id     (string s);
 void  set_wait_handler (void (*) (string, string, int));
 void  system_wait (string message, string argument= "", int level= 0);
 
+/******************************************************************************
+* Slices of strings for appending a range of characters without a temporary.
+* A slice holds a counted reference to the underlying string, so it keeps
+* the characters alive; it is not a non-owning view.
+******************************************************************************/
+
+class string_slice {
+public:
+  string s;
+  int    start;
+  int    end;
+  inline string_slice (string s2, int start2, int end2):
+    s (s2), start (start2), end (end2) {}
+  inline char operator [] (int i) { return s[start+i]; }
+};
+
+inline int N (string_slice x) { return x.end - x.start; }
+string_slice slice (string s, int start, int end);
+string&  operator << (string& a, string_slice x);
+
 /******************************************************************************
 * C-style strings with automatic memory management
 ******************************************************************************/
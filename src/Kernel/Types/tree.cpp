@@ -12,6 +12,7 @@
 #include "generic_tree.hpp"
 #include "drd_std.hpp"
 #include "hashset.hpp"
+#include "hashmap.hpp"
 
 /******************************************************************************
 * Main routines for trees
@@ -30,66 +31,66 @@ destroy_tree_rep (tree_rep* rep) {
 tree::tree (tree_label l, tree t1):
   rep (tm_new<compound_rep> (l, array<tree> (1)))
 {
-  (static_cast<compound_rep*> (rep))->a[0]=t1;
+  (static_cast<compound_rep*> (rep))->a[0]=std::move (t1);
 }
 
 tree::tree (tree_label l, tree t1, tree t2):
   rep (tm_new<compound_rep> (l, array<tree> (2)))
 {
-  (static_cast<compound_rep*> (rep))->a[0]=t1;
-  (static_cast<compound_rep*> (rep))->a[1]=t2;
+  (static_cast<compound_rep*> (rep))->a[0]=std::move (t1);
+  (static_cast<compound_rep*> (rep))->a[1]=std::move (t2);
 }
 
 tree::tree (tree_label l, tree t1, tree t2, tree t3):
   rep (tm_new<compound_rep> (l, array<tree> (3)))
 {
-  (static_cast<compound_rep*> (rep))->a[0]=t1;
-  (static_cast<compound_rep*> (rep))->a[1]=t2;
-  (static_cast<compound_rep*> (rep))->a[2]=t3;
+  (static_cast<compound_rep*> (rep))->a[0]=std::move (t1);
+  (static_cast<compound_rep*> (rep))->a[1]=std::move (t2);
+  (static_cast<compound_rep*> (rep))->a[2]=std::move (t3);
 }
 
 tree::tree (tree_label l, tree t1, tree t2, tree t3, tree t4):
   rep (tm_new<compound_rep> (l, array<tree> (4)))
 {
-  (static_cast<compound_rep*> (rep))->a[0]=t1;
-  (static_cast<compound_rep*> (rep))->a[1]=t2;
-  (static_cast<compound_rep*> (rep))->a[2]=t3;
-  (static_cast<compound_rep*> (rep))->a[3]=t4;
+  (static_cast<compound_rep*> (rep))->a[0]=std::move (t1);
+  (static_cast<compound_rep*> (rep))->a[1]=std::move (t2);
+  (static_cast<compound_rep*> (rep))->a[2]=std::move (t3);
+  (static_cast<compound_rep*> (rep))->a[3]=std::move (t4);
 }
 
 tree::tree (tree_label l, tree t1, tree t2, tree t3, tree t4, tree t5):
   rep (tm_new<compound_rep> (l, array<tree> (5)))
 {
-  (static_cast<compound_rep*> (rep))->a[0]=t1;
-  (static_cast<compound_rep*> (rep))->a[1]=t2;
-  (static_cast<compound_rep*> (rep))->a[2]=t3;
-  (static_cast<compound_rep*> (rep))->a[3]=t4;
-  (static_cast<compound_rep*> (rep))->a[4]=t5;
+  (static_cast<compound_rep*> (rep))->a[0]=std::move (t1);
+  (static_cast<compound_rep*> (rep))->a[1]=std::move (t2);
+  (static_cast<compound_rep*> (rep))->a[2]=std::move (t3);
+  (static_cast<compound_rep*> (rep))->a[3]=std::move (t4);
+  (static_cast<compound_rep*> (rep))->a[4]=std::move (t5);
 }
 
 tree::tree (tree_label l,
 	    tree t1, tree t2, tree t3, tree t4, tree t5, tree t6):
   rep (tm_new<compound_rep> (l, array<tree> (6)))
 {
-  (static_cast<compound_rep*> (rep))->a[0]=t1;
-  (static_cast<compound_rep*> (rep))->a[1]=t2;
-  (static_cast<compound_rep*> (rep))->a[2]=t3;
-  (static_cast<compound_rep*> (rep))->a[3]=t4;
-  (static_cast<compound_rep*> (rep))->a[4]=t5;
-  (static_cast<compound_rep*> (rep))->a[5]=t6;
+  (static_cast<compound_rep*> (rep))->a[0]=std::move (t1);
+  (static_cast<compound_rep*> (rep))->a[1]=std::move (t2);
+  (static_cast<compound_rep*> (rep))->a[2]=std::move (t3);
+  (static_cast<compound_rep*> (rep))->a[3]=std::move (t4);
+  (static_cast<compound_rep*> (rep))->a[4]=std::move (t5);
+  (static_cast<compound_rep*> (rep))->a[5]=std::move (t6);
 }
 
 tree::tree (tree_label l,
 	    tree t1, tree t2, tree t3, tree t4, tree t5, tree t6, tree t7):
   rep (tm_new<compound_rep> (l, array<tree> (7)))
 {
-  (static_cast<compound_rep*> (rep))->a[0]=t1;
-  (static_cast<compound_rep*> (rep))->a[1]=t2;
-  (static_cast<compound_rep*> (rep))->a[2]=t3;
-  (static_cast<compound_rep*> (rep))->a[3]=t4;
-  (static_cast<compound_rep*> (rep))->a[4]=t5;
-  (static_cast<compound_rep*> (rep))->a[5]=t6;
-  (static_cast<compound_rep*> (rep))->a[6]=t7;
+  (static_cast<compound_rep*> (rep))->a[0]=std::move (t1);
+  (static_cast<compound_rep*> (rep))->a[1]=std::move (t2);
+  (static_cast<compound_rep*> (rep))->a[2]=std::move (t3);
+  (static_cast<compound_rep*> (rep))->a[3]=std::move (t4);
+  (static_cast<compound_rep*> (rep))->a[4]=std::move (t5);
+  (static_cast<compound_rep*> (rep))->a[5]=std::move (t6);
+  (static_cast<compound_rep*> (rep))->a[6]=std::move (t7);
 }
 
 tree::tree (tree_label l,
@@ -97,14 +98,14 @@ tree::tree (tree_label l,
 	    tree t5, tree t6, tree t7, tree t8):
   rep (tm_new<compound_rep> (l, array<tree> (8)))
 {
-  (static_cast<compound_rep*> (rep))->a[0]=t1;
-  (static_cast<compound_rep*> (rep))->a[1]=t2;
-  (static_cast<compound_rep*> (rep))->a[2]=t3;
-  (static_cast<compound_rep*> (rep))->a[3]=t4;
-  (static_cast<compound_rep*> (rep))->a[4]=t5;
-  (static_cast<compound_rep*> (rep))->a[5]=t6;
-  (static_cast<compound_rep*> (rep))->a[6]=t7;
-  (static_cast<compound_rep*> (rep))->a[7]=t8;
+  (static_cast<compound_rep*> (rep))->a[0]=std::move (t1);
+  (static_cast<compound_rep*> (rep))->a[1]=std::move (t2);
+  (static_cast<compound_rep*> (rep))->a[2]=std::move (t3);
+  (static_cast<compound_rep*> (rep))->a[3]=std::move (t4);
+  (static_cast<compound_rep*> (rep))->a[4]=std::move (t5);
+  (static_cast<compound_rep*> (rep))->a[5]=std::move (t6);
+  (static_cast<compound_rep*> (rep))->a[6]=std::move (t7);
+  (static_cast<compound_rep*> (rep))->a[7]=std::move (t8);
 }
 
 tree
@@ -154,6 +155,20 @@ freeze (tree t) {
   }
 }
 
+void
+share (tree t) {
+  // Mark t and its subtrees for use by several threads; observers and
+  // the contents of generic trees are not shared
+  REF_SHARE (t.rep);
+  if (is_atomic (t)) share (t->label);
+  else if (is_compound (t)) {
+    int i, n= N(t);
+    share (A(t));
+    for (i=0; i<n; i++)
+      share (t[i]);
+  }
+}
+
 tree
 operator * (tree t1, tree t2) {
   int i;
@@ -168,13 +183,15 @@ operator * (tree t1, tree t2) {
 tree&
 operator << (tree& t, tree t2) {
   CHECK_COMPOUND (t);
-  (static_cast<compound_rep*> (t.rep))->a << t2;
+  CHECK_MUTABLE (t);
+  (static_cast<compound_rep*> (t.rep))->a << std::move (t2);
   return t;
 }
 
 tree&
 operator << (tree& t, array<tree> a) {
   CHECK_COMPOUND (t);
+  CHECK_MUTABLE (t);
   (static_cast<compound_rep*> (t.rep))->a << a;
   return t;
 }
@@ -223,6 +240,71 @@ hash (tree t) {
   else return ((int) L(t)) ^ hash (A(t));
 }
 
+/******************************************************************************
+* Hash-consing of immutable trees
+******************************************************************************/
+
+// Interned trees are maximally shared, so that equal interned trees are
+// represented by the same pointer.  They are owned by the interning table
+// and must never be modified: use copy (t) to obtain an editable version.
+// Modifications through the observer interface (assign, insert, ...) are
+// refused for interned trees and trees inside them, and so are appends
+// with << when debug_trees is defined.  Assignments t[i]= ... cannot be
+// checked, since tree::operator [] also serves for reading; interned trees
+// are only handed out to readers: the typesetter and its environment
+// (exec_use_package, style caches), the drd and tree-load-style.
+//
+// Whether a tree is interned is recorded in a set of representations
+// rather than in tree_rep, so as to keep all other trees small.
+// intern_reset () empties this set together with the interning table:
+// trees which were interned before remain alive for their other owners,
+// but are no longer interned and no longer shared with new interned trees.
+
+static hashmap<tree,tree>* interned= NULL;
+static hashset<pointer>* interned_reps= NULL;
+
+bool
+is_interned (tree t) {
+  return interned_reps != NULL &&
+         (*interned_reps)->contains ((pointer) inside (t));
+}
+
+tree
+intern (tree t) {
+  if (interned == NULL) {
+    interned= tm_new<hashmap<tree,tree> > ();
+    interned_reps= tm_new<hashset<pointer> > ();
+  }
+  if (is_interned (t)) return t;
+  if (is_atomic (t)) {
+    if ((*interned)->contains (t)) return (*interned) [t];
+    tree r (copy (t->label));
+    (*interned_reps)->insert ((pointer) inside (r));
+    (*interned) (r)= r;
+    return r;
+  }
+  else if (is_compound (t)) {
+    int i, n= N(t);
+    tree r (t, n);
+    for (i=0; i<n; i++) r[i]= intern (t[i]);
+    if ((*interned)->contains (r)) return (*interned) [r];
+    (*interned_reps)->insert ((pointer) inside (r));
+    (*interned) (r)= r;
+    return r;
+  }
+  else return t;
+}
+
+void
+intern_reset () {
+  if (interned != NULL) {
+    tm_delete (interned);
+    tm_delete (interned_reps);
+    interned= NULL;
+    interned_reps= NULL;
+  }
+}
+
 string
 tree_as_string (tree t) {
   if (is_atomic (t)) return t->label;
@@ -26,6 +26,7 @@ class compound_rep;
 class generic_rep;
 class blackbox;
 tree copy (tree t);
+void share (tree t);
 
 class tree {
   tree_rep* rep; // can be atomic or compound or generic
@@ -33,6 +34,7 @@ class tree {
 
 public:
   inline tree (const tree& x);
+  inline tree (tree&& x);
   inline ~tree ();
   inline atomic_rep* operator -> ();
   inline tree& operator = (tree x);
@@ -78,6 +80,7 @@ public:
 
   friend tree copy (tree t);
   friend tree freeze (tree t);
+  friend void share (tree t);
   friend bool operator == (tree t, tree u);
   friend bool operator != (tree t, tree u);
   friend tree& operator << (tree& t, tree t2);
@@ -105,6 +108,7 @@ public:
   observer obs;
   inline tree_rep (tree_label op2): op (op2) {}
   friend class tree;
+  friend void share (tree t);
 };
 
 class atomic_rep: public tree_rep {
@@ -146,23 +150,31 @@ typedef tree scheme_tree;
     failed_error << "The tree : " << (t) << "\n"; \
     FAILED ("compound tree expected"); \
   }
+#define CHECK_MUTABLE(t) \
+  if (is_interned (t)) { \
+    failed_error << "The tree : " << (t) << "\n"; \
+    FAILED ("interned trees cannot be modified"); \
+  }
 #else
 #define CHECK_ATOMIC(t)
 #define CHECK_COMPOUND(t)
+#define CHECK_MUTABLE(t)
 #endif
 
 void destroy_tree_rep (tree_rep* rep);
-inline tree::tree (tree_rep* rep2): rep (rep2) { rep->ref_count++; }
-inline tree::tree (const tree& x): rep (x.rep) { rep->ref_count++; }
+inline tree::tree (tree_rep* rep2): rep (rep2) { REF_INC (rep); }
+inline tree::tree (const tree& x): rep (x.rep) { REF_INC (rep); }
+inline tree::tree (tree&& x): rep (x.rep) { x.rep= NULL; }
 inline tree::~tree () {
-  if ((--rep->ref_count)==0) { destroy_tree_rep (rep); rep= NULL; } }
+  if (rep != NULL && REF_DEC (rep)==0) {
+    destroy_tree_rep (rep); rep= NULL; } }
 inline atomic_rep* tree::operator -> () {
   CHECK_ATOMIC (*this);
   return static_cast<atomic_rep*> (rep); }
 inline tree& tree::operator = (tree x) {
-  x.rep->ref_count++;
-  if ((--rep->ref_count)==0) destroy_tree_rep (rep);
+  tree_rep* old= rep;
   rep= x.rep;
+  x.rep= old;
   return *this; }
 
 inline tree::tree ():
@@ -374,6 +386,9 @@ inline tree verbatim (tree t1) {
 
 tree   correct (tree t);
 int    hash (tree t);
+tree   intern (tree t);
+bool   is_interned (tree t);
+void   intern_reset ();
 
 template<class T>
 array<T>::operator tree () {
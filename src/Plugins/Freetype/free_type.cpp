@@ -43,6 +43,8 @@ FT_Error (*ft_get_kerning)    (FT_Face        face,
                                FT_UInt        right_glyph,
                                FT_UInt        kern_mode,
                                FT_Vector      *akerning);
+void     (*ft_outline_get_cbox) (const FT_Outline* outline,
+                                 FT_BBox*          acbox);
 
 typedef FT_Error (*glyph_renderer) (FT_GlyphSlot, FT_Render_Mode);
 
@@ -59,6 +61,7 @@ ft_initialize () {
   ft_load_glyph    = FT_Load_Glyph;
   ft_render_glyph  = (glyph_renderer) ((void*) FT_Render_Glyph);
   ft_get_kerning   = FT_Get_Kerning;
+  ft_outline_get_cbox= FT_Outline_Get_CBox;
   if (ft_init_freetype (&ft_library)) return true;
   if (DEBUG_AUTO) debug_automatic << "With linked TrueType support\n";
 #else
@@ -84,6 +87,9 @@ ft_initialize () {
   (void) symbol_install ("/usr/lib/libfreetype.so", "FT_Render_Glyph"  ,
 			 (pointer&) ft_render_glyph);
   if (ft_render_glyph == NULL) return true;
+  (void) symbol_install ("/usr/lib/libfreetype.so", "FT_Outline_Get_CBox",
+			 (pointer&) ft_outline_get_cbox);
+  if (ft_outline_get_cbox == NULL) return true;
   debug_on (status);
   if (ft_init_freetype (&ft_library)) return true;
   if (DEBUG_AUTO) debug_automatic << "Installed TrueType support\n";
@@ -19,6 +19,7 @@ bool ft_present ();
 #ifdef USE_FREETYPE
 #include <ft2build.h>
 #include FT_FREETYPE_H 
+#include FT_OUTLINE_H
 
 extern FT_Library ft_library;
 
@@ -45,6 +46,8 @@ extern FT_Error (*ft_get_kerning)    (FT_Face        face,
                                       FT_UInt        right_glyph,
                                       FT_UInt        kern_mode,
                                       FT_Vector      *akerning);
+extern void     (*ft_outline_get_cbox) (const FT_Outline* outline,
+                                        FT_BBox*          acbox);
 
 #endif
 
@@ -14,6 +14,8 @@
 #include "tt_face.hpp"
 #include "tt_file.hpp"
 #include "tm_timer.hpp"
+#include "file.hpp"
+#include "iterator.hpp"
 
 #ifdef USE_FREETYPE
 
@@ -63,42 +65,98 @@ load_tt_face (string name) {
 
 static metric error_metric;
 
+// Rasterize glyphs in order to determine their ink extents?  By default,
+// the extents are computed from the control boxes of the outlines, which
+// gives the same sizes as the monochrome renderer; rendering is only used
+// for glyphs which are neither outlines nor bitmaps.
+static bool tt_metrics_by_rendering= false;
+
+void
+tt_render_metrics (bool flag) {
+  tt_metrics_by_rendering= flag;
+}
+
+static bool
+tt_ink_size (FT_GlyphSlot slot, int& w, int& h) {
+  // width and height in pixels of the bitmap for slot
+  if (slot->format == FT_GLYPH_FORMAT_OUTLINE && !tt_metrics_by_rendering) {
+    // same rounding as FreeType's monochrome renderer: the edges of
+    // the control box are rounded to the nearest pixel boundary, with
+    // ties widening the box, and collapsed boxes get one pixel
+    FT_BBox cb;
+    ft_outline_get_cbox (&slot->outline, &cb);
+    FT_Pos x1= (cb.xMin >> 6) + ((cb.xMin & 63) > 32);
+    FT_Pos x2= (cb.xMax >> 6) + ((cb.xMax & 63) > 31);
+    FT_Pos y1= (cb.yMin >> 6) + ((cb.yMin & 63) > 32);
+    FT_Pos y2= (cb.yMax >> 6) + ((cb.yMax & 63) > 31);
+    if (x1 == x2) x2++;
+    if (y1 == y2) y2++;
+    w= (int) (x2 - x1);
+    h= (int) (y2 - y1);
+    return false;
+  }
+  if (slot->format != FT_GLYPH_FORMAT_BITMAP &&
+      ft_render_glyph (slot, ft_render_mode_mono)) return true;
+  w= slot->bitmap.width;
+  h= slot->bitmap.rows;
+  return false;
+}
+
 tt_font_metric_rep::tt_font_metric_rep (
-  string name, string family, int size2, int hdpi2, int vdpi2):
-  font_metric_rep (name), size (size2), hdpi (hdpi2), vdpi (vdpi2), fnm (NULL)
+  string name, string family2, int size2, int hdpi2, int vdpi2):
+  font_metric_rep (name), family (family2),
+  size (size2), hdpi (hdpi2), vdpi (vdpi2),
+  fnm (NULL), fex (false), fkern (0), has_kerning (false),
+  cache_changed (false)
 {
-  face= load_tt_face (family);
-  bad_font_metric= face->bad_face ||
-    ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi);
-  if (bad_font_metric) return;
-
   error_metric->x1= error_metric->y1= 0;
   error_metric->x2= error_metric->y2= 0;
   error_metric->x3= error_metric->y3= 0;
   error_metric->x4= error_metric->y4= 0;
+
+  font_file= tt_font_find (family);
+  bad_font_metric= is_none (font_file);
+  if (bad_font_metric || load_cache ()) return;
+  bad_font_metric= load_face () ||
+    ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi);
+  if (bad_font_metric) return;
+  has_kerning= FT_HAS_KERNING (face->ft_face);
+  touch_cache ();
+}
+
+bool
+tt_font_metric_rep::load_face () {
+  // returns true if the face could not be loaded
+  if (is_nil (face)) face= load_tt_face (family);
+  return face->bad_face;
 }
 
 bool
 tt_font_metric_rep::exists (int i) {
-  if (face->bad_face) return false;
+  if (bad_font_metric) return false;
   if (fnm->contains (i)) return true;
+  if (fex->contains (i)) return fex[i];
+  if (load_face ()) return false;
   FT_UInt glyph_index= decode_index (face->ft_face, i);
-  return glyph_index != 0;
+  fex(i)= (glyph_index != 0);
+  touch_cache ();
+  return fex[i];
 }
 
 metric&
 tt_font_metric_rep::get (int i) {
-  if (!face->bad_face && !fnm->contains(i)) {
+  if (!bad_font_metric && !fnm->contains(i)) {
+    if (load_face ()) return error_metric;
     ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi);
     FT_UInt glyph_index= decode_index (face->ft_face, i);
     if (ft_load_glyph (face->ft_face, glyph_index, FT_LOAD_DEFAULT))
       return error_metric;
     FT_GlyphSlot slot= face->ft_face->glyph;
-    if (ft_render_glyph (slot, ft_render_mode_mono)) return error_metric;
+    int w, h;
+    if (tt_ink_size (slot, w, h)) return error_metric;
     metric_struct* M= tm_new<metric_struct> ();
     fnm(i)= (pointer) M;
-    int w= slot->bitmap.width;
-    int h= slot->bitmap.rows;
+    touch_cache ();
     SI ww= w * PIXEL;
     SI hh= h * PIXEL;
     SI xw= tt_si (slot->metrics.width);
@@ -126,13 +184,165 @@ tt_font_metric_rep::get (int i) {
 
 SI
 tt_font_metric_rep::kerning (int left, int right) {
-  if (face->bad_face || !FT_HAS_KERNING (face->ft_face)) return 0;
+  if (bad_font_metric || !has_kerning) return 0;
+  pair<int,int> p (left, right);
+  if (fkern->contains (p)) return fkern[p];
+  if (load_face ()) return 0;
   FT_Vector k;
   FT_UInt l= decode_index (face->ft_face, left);
   FT_UInt r= decode_index (face->ft_face, right);
   ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi);
   if (ft_get_kerning (face->ft_face, l, r, FT_KERNING_DEFAULT, &k)) return 0;
-  return tt_si (k.x);
+  fkern(p)= tt_si (k.x);
+  touch_cache ();
+  return fkern[p];
+}
+
+/******************************************************************************
+* Persistent cache for font metrics
+*******************************************************************************
+* The metrics of each font, size and resolution which were needed during
+* a session are saved in a small binary file, so that later sessions can
+* get them without opening the font file.  The header records the location,
+* size and modification date of the font file; the file is ignored if
+* one of them changed, or if the trailing checksum does not match.
+* All numbers are stored as 32 bit little endian integers.
+******************************************************************************/
+
+#define TT_CACHE_MAGIC   0x4d4d5454 // "TTMM"
+#define TT_CACHE_VERSION 2
+
+static array<pointer> tt_changed_metrics;
+
+static void
+cache_put (string& s, int i) {
+  unsigned int u= (unsigned int) i;
+  s << (char) (u & 255) << (char) ((u >> 8) & 255)
+    << (char) ((u >> 16) & 255) << (char) ((u >> 24) & 255);
+}
+
+static int
+cache_get (string s, int& pos) {
+  // the caller checks that there are enough bytes left
+  unsigned int u=
+    ((unsigned int) (unsigned char) s[pos]) |
+    (((unsigned int) (unsigned char) s[pos+1]) << 8) |
+    (((unsigned int) (unsigned char) s[pos+2]) << 16) |
+    (((unsigned int) (unsigned char) s[pos+3]) << 24);
+  pos += 4;
+  return (int) u;
+}
+
+static string
+cache_header (url font_file, int size, int hdpi, int vdpi) {
+  string h, name= as_string (font_file);
+  cache_put (h, TT_CACHE_MAGIC);
+  cache_put (h, TT_CACHE_VERSION);
+  cache_put (h, file_size (font_file));
+  cache_put (h, last_modified (font_file, false));
+  cache_put (h, size);
+  cache_put (h, hdpi);
+  cache_put (h, vdpi);
+  cache_put (h, tt_metrics_by_rendering? 1: 0);
+  cache_put (h, N(name));
+  h << name;
+  return h;
+}
+
+url
+tt_font_metric_rep::cache_file () {
+  return url ("$TEXMACS_HOME_PATH/system/cache/metrics", res_name * ".bin");
+}
+
+void
+tt_font_metric_rep::touch_cache () {
+  if (cache_changed) return;
+  cache_changed= true;
+  tt_changed_metrics << ((pointer) this);
+}
+
+bool
+tt_font_metric_rep::load_cache () {
+  // returns true if the metrics were loaded from the cache
+  string s;
+  if (load_string (cache_file (), s, false)) return false;
+  string h= cache_header (font_file, size, hdpi, vdpi);
+  int n= N(s), pos= N(h);
+  if (n < pos + 16 || s (0, pos) != h) return false;
+  int check= n - 4;
+  if (cache_get (s, check) != hash (s (0, n - 4))) return false;
+  has_kerning= (cache_get (s, pos) != 0);
+  int nm= cache_get (s, pos);
+  if (nm < 0 || pos + 36 * nm + 8 > n) return false;
+  for (int k=0; k<nm; k++) {
+    int i= cache_get (s, pos);
+    metric_struct* M= tm_new<metric_struct> ();
+    M->x1= cache_get (s, pos); M->y1= cache_get (s, pos);
+    M->x2= cache_get (s, pos); M->y2= cache_get (s, pos);
+    M->x3= cache_get (s, pos); M->y3= cache_get (s, pos);
+    M->x4= cache_get (s, pos); M->y4= cache_get (s, pos);
+    fnm(i)= (pointer) M;
+  }
+  int ne= cache_get (s, pos);
+  if (ne < 0 || pos + 8 * ne + 4 > n) return false;
+  for (int k=0; k<ne; k++) {
+    int i= cache_get (s, pos);
+    fex(i)= (cache_get (s, pos) != 0);
+  }
+  int nk= cache_get (s, pos);
+  if (nk < 0 || pos + 12 * nk + 4 != n) return false;
+  for (int k=0; k<nk; k++) {
+    int l= cache_get (s, pos);
+    int r= cache_get (s, pos);
+    fkern (pair<int,int> (l, r))= cache_get (s, pos);
+  }
+  if (DEBUG_VERBOSE)
+    debug_fonts << "Loaded cached metrics for " << res_name << "\n";
+  return true;
+}
+
+void
+tt_font_metric_rep::save_cache () {
+  if (bad_font_metric) return;
+  string s= cache_header (font_file, size, hdpi, vdpi);
+  cache_put (s, has_kerning? 1: 0);
+  cache_put (s, N(fnm));
+  iterator<int> it= iterate (fnm);
+  while (it->busy ()) {
+    int i= it->next ();
+    metric_struct* M= (metric_struct*) fnm[i];
+    cache_put (s, i);
+    cache_put (s, M->x1); cache_put (s, M->y1);
+    cache_put (s, M->x2); cache_put (s, M->y2);
+    cache_put (s, M->x3); cache_put (s, M->y3);
+    cache_put (s, M->x4); cache_put (s, M->y4);
+  }
+  cache_put (s, N(fex));
+  it= iterate (fex);
+  while (it->busy ()) {
+    int i= it->next ();
+    cache_put (s, i);
+    cache_put (s, fex[i]? 1: 0);
+  }
+  cache_put (s, N(fkern));
+  iterator<pair<int,int> > kt= iterate (fkern);
+  while (kt->busy ()) {
+    pair<int,int> p= kt->next ();
+    cache_put (s, p.x1);
+    cache_put (s, p.x2);
+    cache_put (s, fkern[p]);
+  }
+  cache_put (s, hash (s));
+  (void) save_string (cache_file (), s);
+  cache_changed= false;
+}
+
+void
+tt_metric_cache_save () {
+  // save the metrics which were computed since the last call
+  for (int i=0; i<N(tt_changed_metrics); i++)
+    ((tt_font_metric_rep*) tt_changed_metrics[i])->save_cache ();
+  tt_changed_metrics= array<pointer> ();
 }
 
 font_metric
@@ -150,20 +360,20 @@ tt_font_metric (string family, int size, int hdpi, int vdpi) {
 static glyph error_glyph;
 
 tt_font_glyphs_rep::tt_font_glyphs_rep (
-  string name, string family, int size2, int hdpi2, int vdpi2):
-  font_glyphs_rep (name), size (size2),
+  string name, string family2, int size2, int hdpi2, int vdpi2):
+  font_glyphs_rep (name), family (family2), size (size2),
   hdpi (hdpi2), vdpi (vdpi2), fng (glyph ())
 {
-  face= load_tt_face (family);
-  bad_font_glyphs= face->bad_face ||
-    ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi);
-  if (bad_font_glyphs) return;
+  bad_font_glyphs= is_none (tt_font_find (family));
 }
 
 glyph&
 tt_font_glyphs_rep::get (int i) {
-  if (!face->bad_face && !fng->contains(i)) {
-    ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi);
+  if (!bad_font_glyphs && !fng->contains(i)) {
+    if (is_nil (face)) face= load_tt_face (family);
+    if (face->bad_face ||
+        ft_set_char_size (face->ft_face, 0, size<<6, hdpi, vdpi))
+      return error_glyph;
     FT_UInt glyph_index= decode_index (face->ft_face, i);
     if (ft_load_glyph (face->ft_face, glyph_index, FT_LOAD_DEFAULT))
       return error_glyph;
@@ -14,6 +14,8 @@
 #include "bitmap_font.hpp"
 #include "Freetype/free_type.hpp"
 #include "hashmap.hpp"
+#include "ntuple.hpp"
+#include "url.hpp"
 
 #ifdef USE_FREETYPE
 
@@ -27,22 +29,35 @@ struct tt_face_rep: rep<tt_face> {
 
 struct tt_font_metric_rep: font_metric_rep {
   bool bad_metric;
-  tt_face face;
+  string family;
+  tt_face face;              // only loaded when the metric cache is missing
   int size, hdpi, vdpi;
-  hashmap<int,pointer> fnm;
+  char_table<pointer> fnm;
+  char_table<bool> fex;      // existence of glyphs which are not in fnm
+  hashmap<pair<int,int>,SI> fkern;
+  bool has_kerning;
+  url  font_file;
+  bool cache_changed;
   //metric* fnm;
   //bool* done;
   tt_font_metric_rep (string name, string family, int size, int hdpi, int vdpi);
   bool exists (int char_code);
   metric& get (int char_code);
   SI kerning (int left_code, int right_code);
+
+  bool load_face ();
+  url  cache_file ();
+  bool load_cache ();
+  void save_cache ();
+  void touch_cache ();
 };
 
 struct tt_font_glyphs_rep: font_glyphs_rep {
   bool bad_glyphs;
-  tt_face face;
+  string family;
+  tt_face face;              // loaded when the first glyph is needed
   int size, hdpi, vdpi;
-  hashmap<int,glyph> fng;
+  char_table<glyph> fng;
   //glyph* fng;
   //bool* done;
   tt_font_glyphs_rep (string name, string family, int size, int hdpi, int vdpi);
@@ -50,6 +65,8 @@ struct tt_font_glyphs_rep: font_glyphs_rep {
 };
 
 tt_face load_tt_face (string name);
+void tt_render_metrics (bool flag);
+void tt_metric_cache_save ();
 font_metric tt_font_metric (string family, int size, int hdpi, int vdpi);
 //font_glyphs tt_font_glyphs (string family, int size, int hdpi, int vdpi);
 
@@ -1056,7 +1056,7 @@ struct tfm_font_metric_rep: public font_metric_rep {
   tex_font_metric tfm;
   font_glyphs pk;
   double unit;
-  hashmap<int,pointer> ms;
+  char_table<pointer> ms;
   tfm_font_metric_rep (string name, tex_font_metric tfm2,
                        font_glyphs pk2, double unit2):
     font_metric_rep (name), tfm (tfm2), pk (pk2),
@@ -26,24 +26,66 @@
 
 #include "mupdf_picture.hpp"
 
-// manage a single global context for fitz
+#include <mutex>
+
+/******************************************************************************
+* Fitz contexts
+*******************************************************************************
+* The main context is created by the first thread which needs one.  Any
+* other thread (e.g. a thread rendering pages concurrently) gets a clone,
+* which shares the store and the font cache with the main context through
+* the lock callbacks below, and which is dropped when the thread exits.
+* The size of the shared store is bounded by mupdf_store_limit.
+******************************************************************************/
+
+static std::mutex mupdf_mutexes[FZ_LOCK_MAX];
+
+static void
+mupdf_lock (void* user, int lock) {
+  (void) user; mupdf_mutexes[lock].lock (); }
+
+static void
+mupdf_unlock (void* user, int lock) {
+  (void) user; mupdf_mutexes[lock].unlock (); }
+
+static fz_locks_context mupdf_locks= { NULL, mupdf_lock, mupdf_unlock };
+static fz_context* mupdf_main_context= NULL;
+static std::once_flag mupdf_main_once;
+static size_t mupdf_store_limit= FZ_STORE_DEFAULT;
+
+struct mupdf_thread_context {
+  fz_context* ctx;
+  mupdf_thread_context (): ctx (NULL) {}
+  ~mupdf_thread_context () {
+    if (ctx != NULL && ctx != mupdf_main_context) fz_drop_context (ctx); }
+};
+
+static thread_local mupdf_thread_context mupdf_local_context;
+
+static void
+mupdf_new_main_context () {
+  // runs in the thread which will own the main context
+  mupdf_main_context= fz_new_context (NULL, &mupdf_locks, mupdf_store_limit);
+  mupdf_local_context.ctx= mupdf_main_context;
+}
+
+// the context for the current thread
 fz_context*
 mupdf_context () {
-  static fz_context *ctx= NULL;
-  if (!ctx) {
-    ctx= fz_new_context (NULL, NULL, FZ_STORE_UNLIMITED);
-  }
-  return ctx;
+  fz_context* ctx= mupdf_local_context.ctx;
+  if (ctx != NULL) return ctx;
+  std::call_once (mupdf_main_once, mupdf_new_main_context);
+  if (mupdf_local_context.ctx == NULL)
+    mupdf_local_context.ctx= fz_clone_context (mupdf_main_context);
+  return mupdf_local_context.ctx;
 }
 
-// global auxiliary document needed to invoke some functions
-pdf_document*
-mupdf_document () {
-  static pdf_document *doc= NULL;
-  if (!doc) {
-    doc= pdf_create_document (mupdf_context ());
-  }
-  return doc;
+void
+mupdf_set_store_limit (size_t max) {
+  // max == 0 means unlimited; only effective before the first rendering
+  if (mupdf_main_context != NULL)
+    debug_std << "mupdf_set_store_limit : context already created" << LF;
+  mupdf_store_limit= max;
 }
 
 
@@ -92,6 +134,7 @@ struct mupdf_image_rep: concrete_struct {
   fz_image *img;
   mupdf_image_rep (fz_image* img2)
     : img (img2) {
+    REF_SHARE (this); // may be cached for all threads
     fz_keep_image (mupdf_context (), img);
     // get pixmap size
     fz_pixmap *pix= fz_get_pixmap_from_image (mupdf_context (), img,
@@ -134,49 +177,207 @@ class mupdf_pattern {
 CONCRETE_NULL_CODE (mupdf_pattern);
 
 /******************************************************************************
-* pdf fonts
+* Image caches
+*******************************************************************************
+* Caches of images with a bounded size.  The size of an image is estimated
+* by the size of its decoded pixmap; when the total size exceeds the limit,
+* the least recently used images are evicted.  Evicted images which are
+* still in use remain alive until they are no longer referenced.
 ******************************************************************************/
 
-struct mupdf_font_rep: concrete_struct {
-  pdf_font_desc *fn;
-  mupdf_font_rep (pdf_font_desc* _fn)
-    : fn (_fn) {
-    pdf_keep_font (mupdf_context (), fn);
-  }
-  ~mupdf_font_rep() { pdf_drop_font (mupdf_context (), fn); }
-  friend class mupdf_font;
+static size_t mupdf_cache_limit= 64 << 20; // bytes per cache
+
+template<class T>
+struct mupdf_cache_node {
+  T key;
+  mupdf_image im;
+  size_t size;
+  mupdf_cache_node<T>* prev; // more recently used
+  mupdf_cache_node<T>* next; // less recently used
+  mupdf_cache_node (T key2, mupdf_image im2, size_t size2):
+    key (key2), im (im2), size (size2), prev (NULL), next (NULL) {}
 };
 
-class mupdf_font {
-  CONCRETE_NULL (mupdf_font);
-  mupdf_font (pdf_font_desc* _fn):
-    rep (tm_new<mupdf_font_rep> (_fn)) {}
+template<class T>
+class mupdf_image_cache {
+  hashmap<T,pointer> table;
+  mupdf_cache_node<T>* first; // most recently used
+  mupdf_cache_node<T>* last;  // least recently used
+  void unlink (mupdf_cache_node<T>* n);
+  void push_front (mupdf_cache_node<T>* n);
+  void evict ();
+
+public:
+  string name;
+  size_t used;
+  long hits, misses, evictions;
+
+  mupdf_image_cache (string name2):
+    table (NULL), first (NULL), last (NULL), name (name2),
+    used (0), hits (0), misses (0), evictions (0) {}
+  ~mupdf_image_cache () { reset (); }
+  bool lookup (T key, mupdf_image& im);
+  void insert (T key, mupdf_image im);
+  void reset ();
+  void print_statistics ();
 };
 
-CONCRETE_NULL_CODE (mupdf_font);
+template<class T> void
+mupdf_image_cache<T>::unlink (mupdf_cache_node<T>* n) {
+  if (n->prev == NULL) first= n->next; else n->prev->next= n->next;
+  if (n->next == NULL) last = n->prev; else n->next->prev= n->prev;
+  n->prev= n->next= NULL;
+}
+
+template<class T> void
+mupdf_image_cache<T>::push_front (mupdf_cache_node<T>* n) {
+  n->next= first;
+  if (first != NULL) first->prev= n; else last= n;
+  first= n;
+}
+
+template<class T> void
+mupdf_image_cache<T>::evict () {
+  while (last != NULL && used > mupdf_cache_limit && first != last) {
+    mupdf_cache_node<T>* n= last;
+    unlink (n);
+    table->reset (n->key);
+    used -= n->size;
+    evictions++;
+    tm_delete (n);
+  }
+}
+
+template<class T> bool
+mupdf_image_cache<T>::lookup (T key, mupdf_image& im) {
+  pointer ptr= table [key];
+  if (ptr == NULL) { misses++; return false; }
+  mupdf_cache_node<T>* n= (mupdf_cache_node<T>*) ptr;
+  if (n != first) { unlink (n); push_front (n); }
+  im= n->im;
+  hits++;
+  return true;
+}
+
+template<class T> void
+mupdf_image_cache<T>::insert (T key, mupdf_image im) {
+  size_t size= sizeof (mupdf_cache_node<T>);
+  if (!is_nil (im)) size += 4 * ((size_t) im->w) * ((size_t) im->h);
+  pointer ptr= table [key];
+  if (ptr != NULL) {
+    // the image has been inserted concurrently; replace it
+    mupdf_cache_node<T>* n= (mupdf_cache_node<T>*) ptr;
+    unlink (n);
+    used -= n->size;
+    table->reset (key);
+    tm_delete (n);
+  }
+  mupdf_cache_node<T>* n= tm_new<mupdf_cache_node<T> > (key, im, size);
+  table (key)= (pointer) n;
+  push_front (n);
+  used += size;
+  evict ();
+}
+
+template<class T> void
+mupdf_image_cache<T>::reset () {
+  while (first != NULL) {
+    mupdf_cache_node<T>* n= first;
+    first= n->next;
+    tm_delete (n);
+  }
+  last= NULL;
+  table= hashmap<T,pointer> (NULL);
+  used= 0;
+}
+
+template<class T> void
+mupdf_image_cache<T>::print_statistics () {
+  debug_std << name << ": " << (int) (used >> 10) << " kB"
+            << ", " << hits << " hits, " << misses << " misses, "
+            << evictions << " evictions" << LF;
+}
 
 /******************************************************************************
 * Global support variables for all mupdf_renderers
+*******************************************************************************
+* The bitmaps of characters, the images and the native fonts are shared
+* by all threads; they are only accessed while holding mupdf_cache_lock.
+* The patterns are registered in an auxiliary pdf document, which cannot
+* be used concurrently; each thread therefore has its own document and
+* its own pattern caches.
 ******************************************************************************/
 
+static std::mutex mupdf_cache_lock;
+
 // bitmaps of all characters
-static hashmap<basic_character, mupdf_image> character_image;
+static mupdf_image_cache<basic_character> character_image ("character_image");
 
 // caches
-static hashmap<unsigned long long int, mupdf_image> picture_pool;
-static hashmap<tree, mupdf_image>  image_pool;
-static hashmap<tree, mupdf_pattern> pattern_pool;
-static hashmap<tree, mupdf_image> pattern_image_pool;
+static mupdf_image_cache<unsigned long long int> picture_pool ("picture_pool");
+static mupdf_image_cache<tree> image_pool ("image_pool");
 static hashmap<string, mupdf_font> native_fonts;
 
+struct mupdf_thread_pools {
+  pdf_document* doc;
+  hashmap<tree, mupdf_pattern> pattern_pool;
+  mupdf_image_cache<tree> pattern_image_pool;
+  mupdf_thread_pools (): doc (NULL), pattern_image_pool ("pattern_image_pool") {}
+  ~mupdf_thread_pools () {
+    pattern_pool= hashmap<tree, mupdf_pattern> ();
+    pattern_image_pool.reset ();
+    if (doc != NULL) pdf_drop_document (mupdf_context (), doc);
+  }
+};
+
+static thread_local mupdf_thread_pools mupdf_local_pools;
+
+static mupdf_thread_pools&
+mupdf_pools () {
+  // the context has to be created first, so that the pools of
+  // the thread are destroyed before its context
+  (void) mupdf_context ();
+  return mupdf_local_pools;
+}
+
+// auxiliary document needed to invoke some functions
+pdf_document*
+mupdf_document () {
+  mupdf_thread_pools& pools= mupdf_pools ();
+  if (!pools.doc) {
+    pools.doc= pdf_create_document (mupdf_context ());
+  }
+  return pools.doc;
+}
+
 // flush caches
 void del_obj_mupdf_renderer (void)  {
-  character_image= hashmap<basic_character, mupdf_image> ();
-  image_pool=  hashmap<tree, mupdf_image> ();
-  picture_pool= hashmap<unsigned long long int, mupdf_image> ();
-  pattern_pool= hashmap<tree, mupdf_pattern> ();
-  pattern_image_pool= hashmap<tree, mupdf_image> ();
-  native_fonts= hashmap<string, mupdf_font> ();
+  {
+    std::lock_guard<std::mutex> guard (mupdf_cache_lock);
+    character_image.reset ();
+    image_pool.reset ();
+    picture_pool.reset ();
+    native_fonts= hashmap<string, mupdf_font> ();
+  }
+  mupdf_pools ().pattern_pool= hashmap<tree, mupdf_pattern> ();
+  mupdf_pools ().pattern_image_pool.reset ();
+}
+
+void
+mupdf_set_cache_limit (size_t max) {
+  // maximal size in bytes of each of the image caches
+  mupdf_cache_limit= max;
+}
+
+void
+mupdf_cache_statistics () {
+  {
+    std::lock_guard<std::mutex> guard (mupdf_cache_lock);
+    character_image.print_statistics ();
+    image_pool.print_statistics ();
+    picture_pool.print_statistics ();
+  }
+  mupdf_pools ().pattern_image_pool.print_statistics ();
 }
 
 /******************************************************************************
@@ -188,7 +389,7 @@ mupdf_renderer_rep::mupdf_renderer_rep (int w2, int h2)
     pixmap (NULL), dev (NULL), proc (NULL),
     fg (-1), bg (-1),
     lw (-1),
-    in_text (false), cfn ("")
+    in_text (false), cfn (""), cfd ()
 {
   reset_zoom_factor();
 }
@@ -240,6 +441,7 @@ mupdf_renderer_rep::begin (void* handle) {
     lw  = -1;
     current_width = -1.0;
     cfn= "";
+    cfd= mupdf_font ();
     in_text = false;
     clip_level = 0;
     
@@ -431,7 +633,7 @@ mupdf_renderer_rep::register_pattern (brush br, SI pixel) {
   }
   tree p= br->get_pattern ();
   // debug_convert << p << "\n";
-  if (pattern_pool->contains(p)) return;
+  if (mupdf_pools ().pattern_pool->contains(p)) return;
 
   url u;
   SI w, h;
@@ -440,9 +642,7 @@ mupdf_renderer_rep::register_pattern (brush br, SI pixel) {
   tree key= tuple (u->t, as_string (w), as_string (h), eff);
   
   mupdf_image image_pdf;
-  if (pattern_image_pool->contains (key))
-    image_pdf= pattern_image_pool [key];
-  else {
+  if (!mupdf_pools ().pattern_image_pool.lookup (key, image_pdf)) {
     // debug_convert << "Insert pattern image\n";
     image_pdf= get_image (u, w, h, eff, pixel);
     if (is_nil (image_pdf)) {
@@ -455,7 +655,7 @@ mupdf_renderer_rep::register_pattern (brush br, SI pixel) {
         << " after get_image" << LF;
       return;
     }
-    pattern_image_pool(key) = image_pdf;
+    mupdf_pools ().pattern_image_pool.insert (key, image_pdf);
   }
 
   fz_context *ctx= mupdf_context ();
@@ -510,7 +710,7 @@ mupdf_renderer_rep::register_pattern (brush br, SI pixel) {
 
     mupdf_pattern p_pdf (pat);
     pdf_drop_pattern (ctx, pat);
-    pattern_pool (p) = p_pdf;
+    mupdf_pools ().pattern_pool (p) = p_pdf;
   }
 }
 
@@ -519,12 +719,12 @@ mupdf_renderer_rep::select_stroke_pattern (brush br) {
   if (is_nil(br) || br->get_type () != brush_pattern) return;
   tree p_tree= br->get_pattern ();
   register_pattern (br, brushpx == -1 ? pixel : brushpx);
-  if (!pattern_pool->contains (p_tree)) {
+  if (!mupdf_pools ().pattern_pool->contains (p_tree)) {
     convert_error << "mupdf_renderer_rep::select_stroke_pattern: "
                   << "cannot find registered pattern\n";
     return;
   }
-  mupdf_pattern p= pattern_pool [p_tree];
+  mupdf_pattern p= mupdf_pools ().pattern_pool [p_tree];
   proc->op_CS (mupdf_context (), proc, "Pattern",
                fz_device_rgb (mupdf_context ()));
   proc->op_SC_pattern (mupdf_context (), proc, "*stroke-pattern*",
@@ -536,12 +736,12 @@ mupdf_renderer_rep::select_fill_pattern (brush br) {
   if (is_nil(br) || br->get_type () != brush_pattern) return;
   tree p_tree= br->get_pattern ();
   register_pattern (br, brushpx==-1? pixel: brushpx);
-  if (!pattern_pool->contains (p_tree)) {
+  if (!mupdf_pools ().pattern_pool->contains (p_tree)) {
     convert_error << "mupdf_renderer_rep::select_fill_pattern: "
                   << "cannot find registered pattern\n";
     return;
   }
-  mupdf_pattern p= pattern_pool [p_tree];
+  mupdf_pattern p= mupdf_pools ().pattern_pool [p_tree];
   proc->op_CS (mupdf_context (), proc, "Pattern",
                fz_device_rgb (mupdf_context ()));
   proc->op_sc_pattern (mupdf_context (), proc, "*fill-pattern*",
@@ -601,7 +801,7 @@ mupdf_renderer_rep::set_brush (brush br) {
   if (br->get_type () == brush_pattern) {
     tree p_tree= br->get_pattern ();
     register_pattern (br, brushpx == -1 ? pixel : brushpx);
-    if (!pattern_pool->contains (p_tree)) {
+    if (!mupdf_pools ().pattern_pool->contains (p_tree)) {
       convert_error << "mupdf_renderer_rep::set_brush: "
         << "cannot find registered pattern\n";
       return;
@@ -869,14 +1069,19 @@ mupdf_renderer_rep::draw_scalable (scalable im, SI x, SI y, int alpha) {
     url u= im->get_name ();
     tree lookup= tuple (u->t);
     mupdf_image im2;
-    if (image_pool->contains (lookup))
-      im2= image_pool [lookup];
-    else {
+    bool found;
+    {
+      std::lock_guard<std::mutex> guard (mupdf_cache_lock);
+      found= image_pool.lookup (lookup, im2);
+    }
+    if (!found) {
       // FIXME: handle the possibility that the image is not found
       fz_image* fzim= mupdf_load_image (u);
       im2= mupdf_image (fzim);
       fz_drop_image (mupdf_context (), fzim);
-      image_pool (lookup)= im2;
+      share (lookup);
+      std::lock_guard<std::mutex> guard (mupdf_cache_lock);
+      image_pool.insert (lookup, im2);
     }
     if (is_nil (im2)) return;
     rectangle r= im->get_logical_extents ();
@@ -1005,6 +1210,26 @@ pdf_font_desc *load_pdf_font (string fontname) {
   return NULL;
 }
 
+static mupdf_font
+get_native_font (string fontname) {
+  // the descriptor of the returned font is NULL if the font has to be
+  // rendered using bitmap glyphs; the handle keeps the descriptor alive,
+  // also when the caches are flushed
+  {
+    std::lock_guard<std::mutex> guard (mupdf_cache_lock);
+    if (native_fonts->contains (fontname))
+      return native_fonts [fontname];
+  }
+  pdf_font_desc* fontdesc= load_pdf_font (fontname);
+  std::lock_guard<std::mutex> guard (mupdf_cache_lock);
+  if (!native_fonts->contains (fontname)) {
+    share (fontname);
+    native_fonts (fontname)= mupdf_font (fontdesc);
+  }
+  if (fontdesc) pdf_drop_font (mupdf_context (), fontdesc);
+  return native_fonts [fontname];
+}
+
 // FIXME: cannot we handle more easily font size? (also in pdf_hummus)
 static float
 font_size (string name) {
@@ -1038,25 +1263,15 @@ mupdf_renderer_rep::draw (int c, font_glyphs fng, SI x, SI y) {
     // change font
     cfn= fontname;
     // try to find a native font
-    if (!native_fonts->contains (fontname)) {
-      fontdesc= load_pdf_font (fontname);
-      if (fontdesc) {
-        native_fonts (fontname)= mupdf_font (fontdesc);
-        pdf_drop_font (mupdf_context (), fontdesc);
-      } else {
-        native_fonts (fontname)= mupdf_font (NULL);
-        // this means use bitmap glyphs
-      }
-    } else {
-      fontdesc= native_fonts (fontname)->fn;
-    }
+    cfd= get_native_font (fontname);
+    fontdesc= cfd->fn;
     if (fontdesc) {
       // we have a native font
       fsize = font_size (fontname);
       proc->op_Tf (mupdf_context (), proc, "draw", fontdesc, fsize/std_shrinkf);
     }
   } else {
-    fontdesc= native_fonts (fontname)->fn;
+    fontdesc= is_nil (cfd)? NULL: cfd->fn;
   }
   // draw glyph
   if (fontdesc) {
@@ -1096,7 +1311,11 @@ mupdf_renderer_rep::draw (int c, font_glyphs fng, SI x, SI y) {
   // get the pixmap
   color fgc= pen->get_color ();
   basic_character xc (c, fng, std_shrinkf, fgc, 0);
-  mupdf_image mi= character_image [xc];
+  mupdf_image mi;
+  {
+    std::lock_guard<std::mutex> guard (mupdf_cache_lock);
+    character_image.lookup (xc, mi);
+  }
   if (is_nil (mi)) {
     int r, g, b, a;
     get_rgb (fgc, r, g, b, a);
@@ -1130,7 +1349,11 @@ mupdf_renderer_rep::draw (int c, font_glyphs fng, SI x, SI y) {
     fz_image* im= fz_new_image_from_pixmap (mupdf_context (), pix, NULL);
     mi= mupdf_image (im);
     mi->xo= xo; mi->yo= yo;
-    character_image (xc)= mi;
+    share (xc);
+    {
+      std::lock_guard<std::mutex> guard (mupdf_cache_lock);
+      character_image.insert (xc, mi);
+    }
     fz_drop_pixmap (mupdf_context (), pix);
     fz_drop_image (mupdf_context (), im);
   }
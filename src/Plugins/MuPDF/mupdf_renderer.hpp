@@ -18,6 +18,32 @@
 #include <mupdf/pdf.h>
 
 fz_context* mupdf_context ();
+void mupdf_set_store_limit (size_t max);
+void mupdf_set_cache_limit (size_t max);
+void mupdf_cache_statistics ();
+
+/******************************************************************************
+* pdf fonts
+******************************************************************************/
+
+struct mupdf_font_rep: concrete_struct {
+  pdf_font_desc *fn;
+  mupdf_font_rep (pdf_font_desc* _fn)
+    : fn (_fn) {
+    REF_SHARE (this); // cached for all threads
+    pdf_keep_font (mupdf_context (), fn);
+  }
+  ~mupdf_font_rep() { pdf_drop_font (mupdf_context (), fn); }
+  friend class mupdf_font;
+};
+
+class mupdf_font {
+  CONCRETE_NULL (mupdf_font);
+  mupdf_font (pdf_font_desc* _fn):
+    rep (tm_new<mupdf_font_rep> (_fn)) {}
+};
+
+CONCRETE_NULL_CODE (mupdf_font);
 
 /******************************************************************************
 * Graphic renderer
@@ -42,6 +68,7 @@ protected:
   double    prev_text_x, prev_text_y;
   bool      in_text;
   string    cfn;
+  mupdf_font cfd;     // native font for cfn (nil for bitmap glyphs)
   float     fsize;
   
 
@@ -22,7 +22,7 @@ FILE* fstderr;
 * Routines for abstract base class
 ******************************************************************************/
 
-tm_ostream_rep::tm_ostream_rep (): ref_count (0) {}
+tm_ostream_rep::tm_ostream_rep (): ref_count (0) REF_SHARED_INIT {}
 tm_ostream_rep::~tm_ostream_rep () {}
 void tm_ostream_rep::flush () {}
 void tm_ostream_rep::clear () {}
@@ -21,6 +21,9 @@ class tree;
 
 class tm_ostream_rep {
   int ref_count;
+#ifdef SHARED_REF_COUNT
+  bool ref_shared;
+#endif
 
 public:
   tm_ostream_rep ();
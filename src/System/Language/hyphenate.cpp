@@ -14,6 +14,7 @@
 #include "analyze.hpp"
 #include "converter.hpp"
 #include "universal.hpp"
+#include "iterator.hpp"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -21,6 +22,7 @@
 
 #define MAX_SEARCH 10
 #define MAX_BUFFER_SIZE 256
+#define MAX_HYPHEN_MEMO 10000
 
 /*
 static bool
@@ -50,9 +52,10 @@ unpattern (string s, bool utf8) {
   string r;
   for (i=0; i<n; ) {
     while (i<n && is_digit (s[i])) goto_next_char (s, i, utf8);
+    if (i>=n) break;
     j = i;
     goto_next_char (s, j, utf8);
-    if (i<n) r << s(i,j);
+    r << s(i,j);
     i = j;
   }
   return r;
@@ -153,6 +156,39 @@ str_length (string s, bool utf8) {
   else return N(s);
 }
 
+static array<int>
+exceptional_hyphens (string s, string h, bool utf8) {
+  // penalties for the explicit hyphenation h of s
+  array<int> penalty (str_length (s, utf8)-1);
+  int i=0, j=0;
+  while (h[j] == '-') j++;
+  i++; goto_next_char (h, j, utf8);
+  while (i < N(penalty)+1) {
+    penalty[i-1]= HYPH_INVALID;
+    while (j < N(h) && h[j] == '-') {
+      penalty[i-1]= HYPH_STD;
+      j++;
+    }
+    i++;
+    goto_next_char (h, j, utf8);
+  }
+  //cout << s << " --> " << penalty << "\n";
+  return penalty;
+}
+
+static array<int>
+hyphen_penalties (array<int> T) {
+  // penalties from the maximal digits T of the matching patterns
+  int i;
+  array<int> penalty (N(T)-4);
+  for (i=2; i < N(T)-4; i++)
+    penalty [i-2]= (((T[i]&1)==1)? HYPH_STD: HYPH_INVALID);
+  if (N(penalty)>0) penalty[0] = penalty[N(penalty)-1] = HYPH_INVALID;
+  if (N(penalty)>1) penalty[1] = penalty[N(penalty)-2] = HYPH_INVALID;
+  if (N(penalty)>2) penalty[N(penalty)-3] = HYPH_INVALID;
+  return penalty;
+}
+
 array<int>
 get_hyphens (string s,
              hashmap<string,string> patterns,
@@ -162,24 +198,8 @@ get_hyphens (string s,
   if (utf8) s= cork_to_utf8 (uni_locase_all(s));
   else s= uni_locase_all(s);
 
-  if (hyphenations->contains (s)) {
-    string h= hyphenations [s];
-    array<int> penalty (str_length (s, utf8)-1);
-    int i=0, j=0;
-    while (h[j] == '-') j++;
-    i++; goto_next_char (h, j, utf8);
-    while (i < N(penalty)+1) {
-      penalty[i-1]= HYPH_INVALID;
-      while (j < N(h) && h[j] == '-') {
-        penalty[i-1]= HYPH_STD;
-        j++;
-      }
-      i++;
-      goto_next_char (h, j, utf8);
-    }
-    //cout << s << " --> " << penalty << "\n";
-    return penalty;
-  }
+  if (hyphenations->contains (s))
+    return exceptional_hyphens (s, hyphenations [s], utf8);
   else if (utf8) {
     s= "." * s * ".";
     // cout << s << "\n";
@@ -204,14 +224,7 @@ get_hyphens (string s,
         }
       }
 
-    array<int> penalty (N(T)-4);
-    for (i=2; i < N(T)-4; i++)
-      penalty [i-2]= (((T[i]&1)==1)? HYPH_STD: HYPH_INVALID);
-    if (N(penalty)>0) penalty[0] = penalty[N(penalty)-1] = HYPH_INVALID;
-    if (N(penalty)>1) penalty[1] = penalty[N(penalty)-2] = HYPH_INVALID;
-    if (N(penalty)>2) penalty[N(penalty)-3] = HYPH_INVALID;
-    // cout << s << " --> " << penalty << "\n";
-    return penalty;
+    return hyphen_penalties (T);
   }
   else {
     s= "." * s * ".";
@@ -235,17 +248,295 @@ get_hyphens (string s,
         }
       }
 
-    array<int> penalty (N(T)-4);
-    for (i=2; i < N(T)-4; i++)
-      penalty [i-2]= (((T[i]&1)==1)? HYPH_STD: HYPH_INVALID);
-    if (N(penalty)>0) penalty[0] = penalty[N(penalty)-1] = HYPH_INVALID;
-    if (N(penalty)>1) penalty[1] = penalty[N(penalty)-2] = HYPH_INVALID;
-    if (N(penalty)>2) penalty[N(penalty)-3] = HYPH_INVALID;
-    // cout << s << " --> " << penalty << "\n";
-    return penalty;
+    return hyphen_penalties (T);
+  }
+}
+
+/******************************************************************************
+* Compiled hyphenation tables
+******************************************************************************/
+
+static string
+pattern_weights (string r, int len, bool utf8) {
+  // the digits of the pattern r, as read by get_hyphens for a match of len
+  string w (len+1);
+  int j, k;
+  for (j=0, k=0; j<=len; j++) {
+    if (k<N(r) && is_digit (r[k])) {
+      w[j]= (char) (((int) r[k])-((int) '0'));
+      if (utf8) goto_next_char (r, k, utf8); else k++;
+    }
+    else w[j]= (char) 0;
+    if (k >= N(r)) continue;
+    if (utf8) goto_next_char (r, k, utf8); else k++;
+  }
+  return w;
+}
+
+hyphen_table_rep::hyphen_table_rep (string name2, bool utf82):
+  name (name2), utf8 (utf82), loaded (false),
+  hyphenations ("?"), memo (array<int> ()) {}
+
+hyphen_table::hyphen_table (string name, bool utf8):
+  rep (tm_new<hyphen_table_rep> (name, utf8)) {}
+
+void
+hyphen_table_rep::compile (hashmap<string,string> patterns) {
+  // build the trie with the edges in order of creation,
+  // which are encoded as label + 256 * target
+  int i, j, node;
+  array<array<int> > out;
+  out << array<int> ();
+  weight << -1;
+  iterator<string> it= iterate (patterns);
+  while (it->busy ()) {
+    string key= it->next ();
+    for (i=0, node=0; i<N(key); i++) {
+      int c= (int) (unsigned char) key[i], m= N(out[node]);
+      for (j=0; j<m; j++)
+        if ((out[node][j] & 255) == c) break;
+      if (j == m) {
+        out[node] << (c + (N(out) << 8));
+        out << array<int> ();
+        weight << -1;
+      }
+      node= out[node][j] >> 8;
+    }
+    weight[node]= N(weights);
+    weights << pattern_weights (patterns[key],
+                                utf8? str_length (key, utf8): N(key), utf8);
+  }
+
+  // pack the edges, sorted by label
+  int n= N(out);
+  first= array<int> (n+1);
+  for (node=0; node<n; node++) {
+    array<int> e= out[node];
+    for (i=1; i<N(e); i++)
+      for (j=i; j>0 && (e[j-1] & 255) > (e[j] & 255); j--) {
+        int aux= e[j]; e[j]= e[j-1]; e[j-1]= aux; }
+    first[node]= N(next);
+    for (i=0; i<N(e); i++) {
+      chars << (char) (e[i] & 255);
+      next  << (e[i] >> 8);
+    }
   }
+  first[n]= N(next);
 }
 
+/******************************************************************************
+* Caching compiled hyphenation tables
+*******************************************************************************
+* The header of a cached table records the size and modification date of
+* the pattern file; the cache is ignored if one of them changed, or if the
+* trailing checksum does not match.  All numbers are stored as 32 bit
+* little endian integers and arrays and strings are preceded by their size.
+******************************************************************************/
+
+#define HYPHEN_CACHE_MAGIC   0x48505948 // "HYPH"
+#define HYPHEN_CACHE_VERSION 1
+
+static void
+cache_put (string& s, int i) {
+  unsigned int u= (unsigned int) i;
+  s << (char) (u & 255) << (char) ((u >> 8) & 255)
+    << (char) ((u >> 16) & 255) << (char) ((u >> 24) & 255);
+}
+
+static void
+cache_put (string& s, string t) {
+  cache_put (s, N(t));
+  s << t;
+}
+
+static void
+cache_put (string& s, array<int> a) {
+  cache_put (s, N(a));
+  for (int i=0; i<N(a); i++) cache_put (s, a[i]);
+}
+
+static int
+cache_get (string s, int& pos) {
+  // the caller checks that there are enough bytes left
+  unsigned int u=
+    ((unsigned int) (unsigned char) s[pos]) |
+    (((unsigned int) (unsigned char) s[pos+1]) << 8) |
+    (((unsigned int) (unsigned char) s[pos+2]) << 16) |
+    (((unsigned int) (unsigned char) s[pos+3]) << 24);
+  pos += 4;
+  return (int) u;
+}
+
+static bool
+cache_get (string s, int& pos, int end, string& t) {
+  if (pos + 4 > end) return false;
+  int n= cache_get (s, pos);
+  if (n < 0 || n > end - pos) return false;
+  t= s (pos, pos + n);
+  pos += n;
+  return true;
+}
+
+static bool
+cache_get (string s, int& pos, int end, array<int>& a) {
+  if (pos + 4 > end) return false;
+  int i, n= cache_get (s, pos);
+  if (n < 0 || n > (end - pos) / 4) return false;
+  a= array<int> (n);
+  for (i=0; i<n; i++) a[i]= cache_get (s, pos);
+  return true;
+}
+
+url
+hyphen_table_rep::source_file () {
+  return url ("$TEXMACS_PATH/langs/natural/hyphen", "hyphen." * name);
+}
+
+url
+hyphen_table_rep::cache_file () {
+  string suffix= (utf8? string (".utf8.bin"): string (".bin"));
+  return url ("$TEXMACS_HOME_PATH/system/cache/hyphen", name * suffix);
+}
+
+static string
+cache_header (url source, bool utf8) {
+  string h, name= as_string (source);
+  cache_put (h, HYPHEN_CACHE_MAGIC);
+  cache_put (h, HYPHEN_CACHE_VERSION);
+  cache_put (h, file_size (source));
+  cache_put (h, last_modified (source, false));
+  cache_put (h, utf8? 1: 0);
+  cache_put (h, name);
+  return h;
+}
+
+bool
+hyphen_table_rep::load_cache () {
+  // returns true if the compiled table was loaded from the cache
+  string s;
+  if (load_string (cache_file (), s, false)) return false;
+  string h= cache_header (source_file (), utf8);
+  int i, n= N(s), pos= N(h);
+  if (n < pos + 4 || s (0, pos) != h) return false;
+  int check= n - 4;
+  if (cache_get (s, check) != hash (s (0, n - 4))) return false;
+  n -= 4;
+
+  array<int> first2, next2, weight2, hyph2;
+  string chars2, weights2;
+  if (!cache_get (s, pos, n, first2) ||
+      !cache_get (s, pos, n, chars2) ||
+      !cache_get (s, pos, n, next2) ||
+      !cache_get (s, pos, n, weight2) ||
+      !cache_get (s, pos, n, weights2)) return false;
+  int nodes= N(weight2);
+  if (nodes == 0 || N(first2) != nodes + 1 || N(next2) != N(chars2) ||
+      first2[0] != 0 || first2[nodes] != N(next2)) return false;
+  for (i=0; i<nodes; i++)
+    if (first2[i] > first2[i+1] || weight2[i] < -1 ||
+        weight2[i] >= N(weights2)) return false;
+  for (i=0; i<N(next2); i++)
+    if (next2[i] <= 0 || next2[i] >= nodes) return false;
+
+  hashmap<string,string> hyphenations2 ("?");
+  if (pos + 4 > n) return false;
+  int nh= cache_get (s, pos);
+  for (i=0; i<nh; i++) {
+    string word, hyph;
+    if (!cache_get (s, pos, n, word) ||
+        !cache_get (s, pos, n, hyph)) return false;
+    hyphenations2 (word)= hyph;
+  }
+  if (pos != n) return false;
+
+  first= first2; chars= chars2; next= next2;
+  weight= weight2; weights= weights2;
+  hyphenations= hyphenations2;
+  if (DEBUG_VERBOSE)
+    debug_automatic << "TeXmacs] Loaded cached hyphen." << name << "\n";
+  return true;
+}
+
+void
+hyphen_table_rep::save_cache () {
+  string s= cache_header (source_file (), utf8);
+  cache_put (s, first);
+  cache_put (s, chars);
+  cache_put (s, next);
+  cache_put (s, weight);
+  cache_put (s, weights);
+  cache_put (s, N(hyphenations));
+  iterator<string> it= iterate (hyphenations);
+  while (it->busy ()) {
+    string word= it->next ();
+    cache_put (s, word);
+    cache_put (s, hyphenations[word]);
+  }
+  cache_put (s, hash (s));
+  (void) save_string (cache_file (), s);
+}
+
+void
+hyphen_table_rep::load () {
+  loaded= true;
+  if (load_cache ()) return;
+  hashmap<string,string> patterns ("?");
+  load_hyphen_tables (name, patterns, hyphenations, !utf8);
+  compile (patterns);
+  save_cache ();
+}
+
+array<int>
+hyphen_table_rep::get_hyphens (string s) {
+  // same as get_hyphens for the original patterns, but each start position
+  // is matched against all patterns by a single walk through the trie
+  ASSERT (N(s) != 0, "hyphenation of empty string");
+  if (!loaded) load ();
+  array<int>* cached= memo->locate (s);
+  if (cached != NULL) return *cached;
+  if (N(memo) >= MAX_HYPHEN_MEMO) memo= hashmap<string,array<int> > ();
+
+  string w= utf8? cork_to_utf8 (uni_locase_all (s)): uni_locase_all (s);
+  array<int> penalty;
+  if (hyphenations->contains (w))
+    penalty= exceptional_hyphens (w, hyphenations [w], utf8);
+  else {
+    w= "." * w * ".";
+    int i, j, l, len, n= N(w);
+    array<int> T ((utf8? str_length (w, utf8): n) + 1);
+    for (i=0; i<N(T); i++) T[i]=0;
+    for (i=0, l=0; i<n; goto_next_char (w, i, utf8), l++) {
+      int p= i, q, node= 0;
+      for (len=1; len < MAX_SEARCH; len++) {
+        if (utf8) {
+          if (p >= n) break;
+          q= p;
+          goto_next_char (w, q, utf8);
+        }
+        else if ((q= p+1) >= n) break;
+        for (; p<q && node>=0; p++) node= step (node, w[p]);
+        if (node < 0) break;
+        int k= weight[node];
+        if (k >= 0)
+          for (j=0; j<=len; j++)
+            if (((int) weights[k+j]) > T[l+j]) T[l+j]= (int) weights[k+j];
+      }
+    }
+    penalty= hyphen_penalties (T);
+  }
+  memo (s)= penalty;
+  return penalty;
+}
+
+array<int>
+get_hyphens (string s, hyphen_table table) {
+  return table->get_hyphens (s);
+}
+
+/******************************************************************************
+* Hyphenation of strings
+******************************************************************************/
+
 void
 std_hyphenate (string s, int after, string& left, string& right, int penalty) {
   std_hyphenate (s, after, left, right, penalty, false);
@@ -12,6 +12,7 @@
 #ifndef HYPHENATE_H
 #define HYPHENATE_H
 #include "language.hpp"
+#include "url.hpp"
 
 void load_hyphen_tables (string language_name,
                          hashmap<string,string>& patterns,
@@ -26,4 +27,58 @@ void std_hyphenate (string s, int after, string& left, string& right, int pen);
 void std_hyphenate (string s, int after, string& left, string& right, int pen,
                     bool utf8);
 
+
+/******************************************************************************
+* Compiled hyphenation tables
+*******************************************************************************
+* The patterns are stored in a trie whose edges are labeled by bytes.
+* The edges leaving a node are stored contiguously and sorted, starting at
+* first[node].  The digits of the pattern which ends at a node are stored
+* in weights, starting at weight[node], or weight[node] == -1 if no pattern
+* ends there.  The hyphenations of words are cached in memo.
+* The patterns are only loaded when the first word is hyphenated.  Compiled
+* tables are saved in the cache directory and reused as long as the size
+* and the modification date of the pattern file do not change.
+******************************************************************************/
+
+class hyphen_table;
+class hyphen_table_rep: concrete_struct {
+public:
+  string     name;         // the name of the pattern file
+  bool       utf8;         // patterns and words are encoded in UTF-8
+  bool       loaded;       // whether the patterns were loaded
+  array<int> first;        // first edge leaving each node
+  string     chars;        // the labels of the edges
+  array<int> next;         // the targets of the edges
+  array<int> weight;       // start of the digits of each node, or -1
+  string     weights;      // the digits of the patterns
+  hashmap<string,string> hyphenations;
+  hashmap<string,array<int> > memo;
+
+  hyphen_table_rep (string name, bool utf8);
+  void compile (hashmap<string,string> patterns);
+  url  source_file ();
+  url  cache_file ();
+  bool load_cache ();
+  void save_cache ();
+  void load ();
+  inline int step (int node, char c) {
+    int i, end= first[node+1];
+    for (i= first[node]; i<end; i++)
+      if (chars[i] == c) return next[i];
+      else if (((unsigned char) chars[i]) > ((unsigned char) c)) break;
+    return -1; }
+  array<int> get_hyphens (string s);
+
+  friend class hyphen_table;
+};
+
+class hyphen_table {
+  CONCRETE(hyphen_table);
+  hyphen_table (string language_name, bool utf8);
+};
+CONCRETE_CODE(hyphen_table);
+
+array<int> get_hyphens (string s, hyphen_table table);
+
 #endif // defined HYPHENATE_H
@@ -20,8 +20,7 @@
 ******************************************************************************/
 
 struct text_language_rep: language_rep {
-  hashmap<string,string> patterns;
-  hashmap<string,string> hyphenations;
+  hyphen_table hyphens;
 
   text_language_rep (string lan_name, string hyph_name);
   text_property advance (tree t, int& pos);
@@ -30,8 +29,7 @@ struct text_language_rep: language_rep {
 };
 
 text_language_rep::text_language_rep (string lan_name, string hyph_name):
-  language_rep (lan_name), patterns ("?"), hyphenations ("?") {
-    load_hyphen_tables (hyph_name, patterns, hyphenations, true); }
+  language_rep (lan_name), hyphens (hyph_name, false) {}
 
 text_property
 text_language_rep::advance (tree t, int& pos) {
@@ -87,7 +85,7 @@ text_language_rep::advance (tree t, int& pos) {
 
 array<int>
 text_language_rep::get_hyphens (string s) {
-  return ::get_hyphens (s, patterns, hyphenations);
+  return ::get_hyphens (s, hyphens);
 }
 
 void
@@ -103,8 +101,7 @@ text_language_rep::hyphenate (
 ******************************************************************************/
 
 struct french_language_rep: language_rep {
-  hashmap<string,string> patterns;
-  hashmap<string,string> hyphenations;
+  hyphen_table hyphens;
 
   french_language_rep (string lan_name, string hyph_name);
   text_property advance (tree t, int& pos);
@@ -113,8 +110,7 @@ struct french_language_rep: language_rep {
 };
 
 french_language_rep::french_language_rep (string lan_name, string hyph_name):
-  language_rep (lan_name), patterns ("?"), hyphenations ("?") {
-    load_hyphen_tables (hyph_name, patterns, hyphenations, true); }
+  language_rep (lan_name), hyphens (hyph_name, false) {}
 
 inline bool
 is_french_punctuation (char c) {
@@ -185,7 +181,7 @@ french_language_rep::advance (tree t, int& pos) {
 
 array<int>
 french_language_rep::get_hyphens (string s) {
-  return ::get_hyphens (s, patterns, hyphenations);
+  return ::get_hyphens (s, hyphens);
 }
 
 void
@@ -201,8 +197,7 @@ french_language_rep::hyphenate (
 ******************************************************************************/
 
 struct ucs_text_language_rep: language_rep {
-  hashmap<string,string> patterns;
-  hashmap<string,string> hyphenations;
+  hyphen_table hyphens;
 
   ucs_text_language_rep (string lan_name, string hyph_name);
   text_property advance (tree t, int& pos);
@@ -212,8 +207,7 @@ struct ucs_text_language_rep: language_rep {
 };
 
 ucs_text_language_rep::ucs_text_language_rep (string lan_name, string hyph_name):
-  language_rep (lan_name), patterns ("?"), hyphenations ("?")
-  { load_hyphen_tables (hyph_name, patterns, hyphenations, false); }
+  language_rep (lan_name), hyphens (hyph_name, true) {}
 
 text_property
 ucs_text_language_rep::advance (tree t, int& pos) {
@@ -272,7 +266,7 @@ ucs_text_language_rep::advance (tree t, int& pos) {
 
 array<int>
 ucs_text_language_rep::get_hyphens (string s) {
-  return ::get_hyphens (s, patterns, hyphenations, true);
+  return ::get_hyphens (s, hyphens);
 }
 
 void
@@ -155,34 +155,25 @@ do_cache_doc (string name) {
 * Saving and loading the cache to/from disk
 ******************************************************************************/
 
+static url
+cache_file (string buffer, bool binary) {
+  if (!binary) return texmacs_home_path * url ("system/cache/" * buffer);
+  if (ends (buffer, ".scm")) buffer= buffer (0, N(buffer) - 4);
+  return texmacs_home_path * url ("system/cache/" * buffer * ".tmb");
+}
+
 void
 cache_save (string buffer) {
   if (cache_changed->contains (buffer)) {
-    url cache_file= texmacs_home_path * url ("system/cache/" * buffer);
-    string cached;
+    tree cached (TUPLE);
     iterator<tree> it= iterate (cache_data);
-    if (buffer == "file_cache" || buffer == "doc_cache") {
-      while (it->busy ()) {
-        tree ckey= it->next ();
-        if (ckey[0] == buffer) {
-          cached << ckey[1]->label << "\n";
-          cached << cache_data [ckey]->label << "\n";
-          cached << "%-%-tm-cache-%-%\n";
-        }
-      }
+    while (it->busy ()) {
+      tree ckey= it->next ();
+      if (ckey[0] == buffer)
+        cached << ckey[1] << cache_data [ckey];
     }
-    else {
-      cached << "(tuple\n";
-      while (it->busy ()) {
-        tree ckey= it->next ();
-        if (ckey[0] == buffer) {
-          cached << tree_to_scheme (ckey[1]) << " ";
-          cached << tree_to_scheme (cache_data [ckey]) << "\n";
-        }
-      }
-      cached << ")";
-    }
-    (void) save_string (cache_file, cached);
+    (void) save_string (cache_file (buffer, true),
+                        tree_to_texmacs_binary (cached));
     cache_changed->remove (buffer);
   }
 }
@@ -190,10 +181,15 @@ cache_save (string buffer) {
 void
 cache_load (string buffer) {
   if (!cache_loaded->contains (buffer)) {
-    url cache_file = texmacs_home_path * url ("system/cache/" * buffer);
-    //cout << "cache_file "<< cache_file << LF;
     string cached;
-    if (!load_string (cache_file, cached, false)) {
+    if (!load_string (cache_file (buffer, true), cached, false)) {
+      tree t= texmacs_binary_to_tree (cached);
+      if (is_tuple (t))
+        for (int i=0; i<N(t)-1; i+=2)
+          cache_data (tuple (buffer, t[i]))= t[i+1];
+    }
+    // caches of former versions were stored in a textual format
+    else if (!load_string (cache_file (buffer, false), cached, false)) {
       if (buffer == "file_cache" || buffer == "doc_cache") {
         int i=0, n= N(cached);
         while (i<n) {
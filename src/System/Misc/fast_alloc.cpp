@@ -5,6 +5,9 @@
 *              of allocations for each fixed size divisible by
 *              a word legth up to MAX_FAST. Otherwise,
 *              usual memory allocation is used.
+*              Each thread has its own table of linked lists and its
+*              own current chunk, so that no locking is needed for
+*              allocations and deallocations.
 * ASSUMPTIONS: The word size of the computer is 4.
 *              Otherwise, change WORD_LENGTH.
 * COPYRIGHT  : (C) 1999  Joris van der Hoeven
@@ -15,20 +18,119 @@
 ******************************************************************************/
 
 #include "fast_alloc.hpp"
+#include <atomic>
+#include <mutex>
 
-void*   alloc_table[MAX_FAST]; // Static declaration initializes with NULL's
-char*  alloc_mem=NULL;
 #ifdef DEBUG_ON
 char*  alloc_mem_top=NULL;
 char*  alloc_mem_bottom=(char*)((unsigned long long)-1);
 #endif
-size_t alloc_remains=0;
-int    allocated=0;
-int    fast_chunks=0;
-int    large_uses=0;
 int    MEM_DEBUG=0;
 int    mem_used ();
 
+/******************************************************************************
+* Per thread allocation caches
+*******************************************************************************
+* A block which is freed by another thread than the one which allocated it
+* is simply put on the free list of the freeing thread; this is safe since
+* all blocks of a given size are interchangeable.  When a thread terminates,
+* its cache (with its free lists and the remainder of its current chunk)
+* is kept and handed over to the next thread which is created.
+*
+* The cache is released by the destructor of the_release, a thread local
+* object which is constructed when the thread attaches its cache.  Other
+* thread local destructors may still allocate or free blocks afterwards;
+* such a thread is marked as finished and uses exit_cache, which is shared
+* by all finished threads and protected by exit_lock.
+******************************************************************************/
+
+struct alloc_cache {
+  void*   table[MAX_FAST];      // free lists for each size
+  char*   mem;                  // current chunk
+  size_t  remains;              // remaining bytes in current chunk
+  std::atomic<long> used;       // bytes in use, allocated from this cache
+  bool    busy;                 // cache attached to a running thread?
+  alloc_cache* next;            // next cache in the list of all caches
+};
+
+static std::mutex         alloc_lock;        // protects the cache list
+static alloc_cache*       alloc_caches= NULL;
+static std::mutex         exit_lock;         // protects exit_cache
+static alloc_cache*       exit_cache= NULL;  // cache of finished threads
+static std::atomic<long>  fast_chunks (0);
+static std::atomic<long>  large_uses (0);
+static thread_local alloc_cache* the_cache= NULL;
+static thread_local bool  the_thread_finished= false;
+
+#define alloc_ptr(c,i) ((c)->table[i])
+#define ind(ptr) (*((void **) ptr))
+
+struct alloc_cache_release {
+  ~alloc_cache_release () {
+    the_thread_finished= true;
+    if (the_cache == NULL) return;
+    std::lock_guard<std::mutex> guard (alloc_lock);
+    the_cache->busy= false;
+    the_cache= NULL;
+  }
+};
+
+static thread_local alloc_cache_release the_release;
+
+static alloc_cache*
+find_alloc_cache () {
+  // a cache which is not attached to any thread, marked as busy
+  std::lock_guard<std::mutex> guard (alloc_lock);
+  alloc_cache* c;
+  for (c= alloc_caches; c != NULL; c= c->next)
+    if (!c->busy) break;
+  if (c == NULL) {
+    c= (alloc_cache*) calloc (1, sizeof (alloc_cache));
+    if (c == NULL) {
+      cerr << "Fatal error: out of memory\n";
+      abort ();
+    }
+    c->next= alloc_caches;
+    alloc_caches= c;
+  }
+  c->busy= true;
+  return c;
+}
+
+struct alloc_cache_user {
+  // gives access to the cache of the current thread during its lifetime;
+  // finished threads get exit_cache, which remains locked meanwhile
+  alloc_cache* cache;
+  bool shared;
+  inline alloc_cache_user (): cache (the_cache), shared (false) {
+    if (cache == NULL) attach (); }
+  inline ~alloc_cache_user () {
+    if (shared) exit_lock.unlock (); }
+  void attach ();
+};
+
+void
+alloc_cache_user::attach () {
+  if (the_thread_finished) {
+    exit_lock.lock ();
+    if (exit_cache == NULL) exit_cache= find_alloc_cache ();
+    cache = exit_cache;
+    shared= true;
+  }
+  else {
+    cache= find_alloc_cache ();
+    the_cache= cache;
+    (void) &the_release; // constructs the_release, which releases the cache
+  }
+}
+
+static inline void
+add_used (alloc_cache* c, long sz) {
+  // only the owning thread modifies c->used
+  c->used.store (c->used.load (std::memory_order_relaxed) + sz,
+                 std::memory_order_relaxed);
+}
+
 /*****************************************************************************/
 // General purpose fast allocation routines
 /*****************************************************************************/
@@ -43,30 +145,39 @@ safe_malloc (size_t sz) {
   return ptr;
 }
 
-void*
-enlarge_malloc (size_t sz) {
-  if (alloc_remains<sz) {
-    alloc_mem    = (char *) safe_malloc (BLOCK_SIZE);
+static void*
+enlarge_malloc (alloc_cache* c, size_t sz) {
+  if (c->remains<sz) {
+    c->mem    = (char *) safe_malloc (BLOCK_SIZE);
     #ifdef DEBUG_ON
-    alloc_mem_top=alloc_mem_top>=alloc_mem+BLOCK_SIZE?alloc_mem_top:(alloc_mem +BLOCK_SIZE);
-    alloc_mem_bottom=alloc_mem_bottom>alloc_mem?alloc_mem:alloc_mem_bottom;
+    alloc_mem_top=alloc_mem_top>=c->mem+BLOCK_SIZE?alloc_mem_top:(c->mem +BLOCK_SIZE);
+    alloc_mem_bottom=alloc_mem_bottom>c->mem?c->mem:alloc_mem_bottom;
     #endif
-    alloc_remains= BLOCK_SIZE;
+    c->remains= BLOCK_SIZE;
     fast_chunks++;
   }
-  void* ptr= alloc_mem;
-  alloc_mem    += sz;
-  alloc_remains-= sz;
+  void* ptr= c->mem;
+  c->mem    += sz;
+  c->remains-= sz;
   return ptr;
 }
 
+void*
+enlarge_malloc (size_t sz) {
+  alloc_cache_user u;
+  return enlarge_malloc (u.cache, sz);
+}
+
 void*
 fast_alloc (size_t sz) {
   sz= (sz+WORD_LENGTH_INC)&WORD_MASK;
   if (sz<MAX_FAST) {
-    void *ptr= alloc_ptr (sz);
-    if (ptr==NULL) return enlarge_malloc (sz);
-    alloc_ptr (sz)= ind (ptr);
+    alloc_cache_user u;
+    alloc_cache* c= u.cache;
+    add_used (c, sz);
+    void *ptr= alloc_ptr (c, sz);
+    if (ptr==NULL) return enlarge_malloc (c, sz);
+    alloc_ptr (c, sz)= ind (ptr);
     #ifdef DEBUG_ON
     break_stub(ptr);
     #endif
@@ -84,16 +195,19 @@ void
 fast_free (void* ptr, size_t sz) {
   sz=(sz+WORD_LENGTH_INC)&WORD_MASK;
   if (sz<MAX_FAST) {
+    alloc_cache_user u;
+    alloc_cache* c= u.cache;
     #ifdef DEBUG_ON
     break_stub(ptr);
-    break_stub(alloc_ptr (sz));
+    break_stub(alloc_ptr (c, sz));
     #endif
-    ind (ptr)     = alloc_ptr (sz);
-    alloc_ptr (sz)= ptr;
+    add_used (c, - (long) sz);
+    ind (ptr)        = alloc_ptr (c, sz);
+    alloc_ptr (c, sz)= ptr;
   }
   else {
     if (MEM_DEBUG>=3) cout << "Big free of " << sz << " bytes\n";
-    large_uses -= sz;    
+    large_uses -= sz;
     free (ptr);
     if (MEM_DEBUG>=3) cout << "Memory used: " << mem_used () << " bytes\n";
   }
@@ -108,9 +222,12 @@ fast_new (size_t s) {
   s= (s+ WORD_LENGTH+ WORD_LENGTH_INC)&WORD_MASK;
   #endif
   if (s<MAX_FAST) {
-    ptr= alloc_ptr(s);
-    if (ptr==NULL) ptr= enlarge_malloc (s);
-    else alloc_ptr(s)= ind(ptr);
+    alloc_cache_user u;
+    alloc_cache* c= u.cache;
+    add_used (c, s);
+    ptr= alloc_ptr (c, s);
+    if (ptr==NULL) ptr= enlarge_malloc (c, s);
+    else alloc_ptr (c, s)= ind(ptr);
     #ifdef DEBUG_ON
     break_stub(ptr);
     #endif
@@ -169,12 +286,15 @@ fast_delete (void* ptr) {
   size_t s= *((size_t *) ptr);
   #endif
   if (s<MAX_FAST) {
+    alloc_cache_user u;
+    alloc_cache* c= u.cache;
     #ifdef DEBUG_ON
     break_stub(ptr);
-    break_stub(alloc_ptr(s));
+    break_stub(alloc_ptr(c, s));
     #endif
-    ind(ptr)    = alloc_ptr(s);
-    alloc_ptr(s)= ptr;
+    add_used (c, - (long) s);
+    ind(ptr)       = alloc_ptr(c, s);
+    alloc_ptr(c, s)= ptr;
   }
   else {
     if (MEM_DEBUG>=3) cout << "Big free of " << s << " bytes\n";
@@ -193,9 +313,12 @@ void*
 fast_alloc_mw (size_t s)
 {
   if (s<MAX_FAST) {
-    void *ptr= alloc_ptr(s);
-    if (ptr==NULL) return enlarge_malloc (s);
-    alloc_ptr(s)= ind(ptr);
+    alloc_cache_user u;
+    alloc_cache* c= u.cache;
+    add_used (c, s);
+    void *ptr= alloc_ptr(c, s);
+    if (ptr==NULL) return enlarge_malloc (c, s);
+    alloc_ptr(c, s)= ind(ptr);
     return ptr;
   }
   else return safe_malloc (s);
@@ -205,53 +328,58 @@ void
 fast_free_mw (void* ptr, size_t s)
 {
   if (s<MAX_FAST) {
-    ind(ptr)    = alloc_ptr(s);
-    alloc_ptr(s)= ptr;
+    alloc_cache_user u;
+    alloc_cache* c= u.cache;
+    add_used (c, - (long) s);
+    ind(ptr)       = alloc_ptr(c, s);
+    alloc_ptr(c, s)= ptr;
   }
   else free (ptr);
 }
 
 /******************************************************************************
 * Statistics
+*******************************************************************************
+* The statistics are aggregated over all threads.  They are exact
+* when no other threads are allocating memory at the same time.
 ******************************************************************************/
 
+static long
+small_used () {
+  long r= 0;
+  std::lock_guard<std::mutex> guard (alloc_lock);
+  for (alloc_cache* c= alloc_caches; c != NULL; c= c->next)
+    r += c->used.load (std::memory_order_relaxed);
+  return r;
+}
+
 int
-compute_free (void* ptr) {
-  int i=-1;
-  while (ptr!=NULL) {
-    i++;
-    ptr= ind (ptr);
-  }
-  return i;
+mem_threads () {
+  int r= 0;
+  std::lock_guard<std::mutex> guard (alloc_lock);
+  for (alloc_cache* c= alloc_caches; c != NULL; c= c->next)
+    if (c->busy) r++;
+  return r;
 }
 
 int
 mem_used () {
-  int free_bytes= alloc_remains;
-  int chunks_use= BLOCK_SIZE*fast_chunks;
-  int i;
-  for (i=WORD_LENGTH; i<MAX_FAST; i+=WORD_LENGTH)
-    free_bytes += i*compute_free (alloc_table+i);
-  int small_uses= chunks_use- free_bytes;
-  return small_uses+ large_uses;
+  return (int) (small_used () + large_uses);
 }
 
 void
 mem_info () {
   cout << "\n---------------- memory statistics ----------------\n";
-  int free_bytes= alloc_remains;
-  int chunks_use= BLOCK_SIZE*fast_chunks;
-  int i;
-  for (i=WORD_LENGTH; i<MAX_FAST; i+=WORD_LENGTH)
-    free_bytes += i*compute_free (alloc_table+i);
-  int small_uses= chunks_use- free_bytes;
-  int total_uses= small_uses+ large_uses;
+  long chunks_use= BLOCK_SIZE*fast_chunks;
+  long small_uses= small_used ();
+  long total_uses= small_uses+ large_uses;
   // cout << "Fast chunks   : " << chunks_use << " bytes\n";
-  // cout << "Free on chunks: " << alloc_remains << " bytes\n";
+  // cout << "Free on chunks: " << chunks_use- small_uses << " bytes\n";
   cout << "User          : " << total_uses << " bytes\n";
   cout << "Allocator     : " << chunks_use+ large_uses << " bytes\n";
   cout << "Small mallocs : "
        << ((100*((float) small_uses))/((float) total_uses)) << "%\n";
+  cout << "Threads       : " << mem_threads () << "\n";
 }
 
 #ifdef DEBUG_ON
@@ -275,9 +403,12 @@ operator new (size_t s) {
   void* ptr;
   s= (s+ WORD_LENGTH+ WORD_LENGTH_INC)&WORD_MASK;
   if (s<MAX_FAST) {
-    ptr= alloc_ptr(s);
-    if (ptr==NULL) ptr= enlarge_malloc (s);
-    else alloc_ptr(s)= ind(ptr);
+    alloc_cache_user u;
+    alloc_cache* c= u.cache;
+    add_used (c, s);
+    ptr= alloc_ptr(c, s);
+    if (ptr==NULL) ptr= enlarge_malloc (c, s);
+    else alloc_ptr(c, s)= ind(ptr);
   }
   else {
     ptr= safe_malloc (s);
@@ -292,8 +423,11 @@ operator delete (void* ptr) {
   ptr= (void*) (((char*) ptr)- WORD_LENGTH);
   size_t s= *((size_t *) ptr);
   if (s<MAX_FAST) {
-    ind(ptr)    = alloc_ptr(s);
-    alloc_ptr(s)= ptr;
+    alloc_cache_user u;
+    alloc_cache* c= u.cache;
+    add_used (c, - (long) s);
+    ind(ptr)       = alloc_ptr(c, s);
+    alloc_ptr(c, s)= ptr;
   }
   else {
     free (ptr);
@@ -306,9 +440,12 @@ operator new[] (size_t s) {
   void* ptr;
   s= (s+ WORD_LENGTH+ WORD_LENGTH_INC)&WORD_MASK;
   if (s<MAX_FAST) {
-    ptr= alloc_ptr(s);
-    if (ptr==NULL) ptr= enlarge_malloc (s);
-    else alloc_ptr(s)= ind(ptr);
+    alloc_cache_user u;
+    alloc_cache* c= u.cache;
+    add_used (c, s);
+    ptr= alloc_ptr(c, s);
+    if (ptr==NULL) ptr= enlarge_malloc (c, s);
+    else alloc_ptr(c, s)= ind(ptr);
   }
   else {
     ptr= safe_malloc (s);
@@ -323,8 +460,11 @@ operator delete[] (void* ptr) {
   ptr= (void*) (((char*) ptr)- WORD_LENGTH);
   size_t s= *((size_t *) ptr);
   if (s<MAX_FAST) {
-    ind(ptr)    = alloc_ptr(s);
-    alloc_ptr(s)= ptr;
+    alloc_cache_user u;
+    alloc_cache* c= u.cache;
+    add_used (c, - (long) s);
+    ind(ptr)       = alloc_ptr(c, s);
+    alloc_ptr(c, s)= ptr;
   }
   else {
     free (ptr);
@@ -24,19 +24,14 @@
 * Globals
 ******************************************************************************/
 
-extern void*   alloc_table[MAX_FAST]; // Static declaration initializes with NULL's
-extern char*  alloc_mem;
+// Each thread allocates small blocks from its own cache of free lists,
+// see fast_alloc.cpp; only the statistics are shared between threads.
+
 #ifdef DEBUG_ON
 extern char*  alloc_mem_top;
 extern char*  alloc_mem_bottom;
 #endif
 bool break_stub(void* ptr);
-extern size_t alloc_remains;
-extern int    allocated;
-extern int    large_uses;
-
-#define alloc_ptr(i) alloc_table[i]
-#define ind(ptr) (*((void **) ptr))
 
 /******************************************************************************
 * General purpose fast allocation routines
@@ -50,6 +45,7 @@ extern void* fast_new (size_t s);
 extern void  fast_delete (void* ptr);
 
 extern int   mem_used ();
+extern int   mem_threads ();
 extern void  mem_info ();
 void* alloc_check(const char *msg,void *ptr,size_t* sp);
 
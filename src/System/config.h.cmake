@@ -113,6 +113,15 @@
 /* Disable fast memory allocator */
 #cmakedefine NO_FAST_ALLOC 1
 
+/* Atomic reference counts for objects shared between threads */
+#cmakedefine SHARED_REF_COUNT 1
+
+/* Hashmaps with chained buckets instead of open addressing */
+#cmakedefine CHAINED_HASHMAP 1
+
+/* Record the environment lookups for the hashmap benchmark */
+#cmakedefine TRACE_ENV_LOOKUPS 1
+
 /* Use g++ strictly prior to g++ 3.0 */
 #cmakedefine OLD_GNU_COMPILER 1
 
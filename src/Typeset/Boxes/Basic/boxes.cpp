@@ -881,6 +881,19 @@ bool box::operator != (box b2) { return rep!=b2.rep; }
 box::operator tree () { return tree (*rep); }
 tm_ostream& operator << (tm_ostream& out, box b) { return out << ((tree) b); }
 
+void
+share (box b) {
+  // Mark a finished box tree for rendering by several threads.
+  // Only the boxes and their inverse paths are shared; the fonts,
+  // pencils and other resources held by particular boxes are not.
+  if (is_nil (b)) return;
+  REF_SHARE (b.rep);
+  share (b->ip);
+  int i, n= N(b);
+  for (i=0; i<n; i++)
+    share (b[i]);
+}
+
 path
 descend_decode (path ip, int side) {
   if (is_nil (ip)) return descend (ip, side);
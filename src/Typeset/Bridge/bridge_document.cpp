@@ -199,6 +199,11 @@ bridge_document_rep::my_typeset (int desired_status) {
   //cout << INDENT;
   if (is_nil (acc)) {
     int i, n= N(st);
+    if (ttt->par_limit >= 0) {
+      // only the top-level document may be typeset partially
+      n= min (n, ttt->par_limit);
+      ttt->par_limit= -1;
+    }
     array<line_item> a= ttt->a;
     array<line_item> b= ttt->b;
     for (i=0; i<n; i++) {
@@ -28,6 +28,11 @@ public:
   SI x1, y1, x2, y2;
   hashmap<string,tree> old_patch;
   bool paper;
+  int  par_limit;          // only typeset the first paragraphs (-1: all)
+
+  array<page_item> pages_prev_l; // page items at the previous page breaking
+  skeleton  pages_prev_sk;       // the resulting skeleton
+  string    pages_prev_pars;     // and the page breaking parameters
 
 public:
   typesetter_rep (edit_env& env, tree et, path ip);
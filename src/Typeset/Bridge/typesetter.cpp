@@ -17,7 +17,7 @@
 ******************************************************************************/
 
 typesetter_rep::typesetter_rep (edit_env& env2, tree et, path ip):
-  env (env2), old_patch (UNINIT)
+  env (env2), old_patch (UNINIT), par_limit (-1)
 {
   paper= (env->get_string (PAGE_MEDIUM) == "paper");
   br= make_bridge (this, et, ip);
@@ -157,6 +157,10 @@ typesetter_rep::typeset () {
     if (!is_compound (st[i], "show-part")) break;
   }
 
+  // Test whether we only typeset the beginning of the document
+  bool partial= (par_limit >= 0 && par_limit < n && is_func (st, DOCUMENT));
+  if (partial) env->complete= false;
+
   // Typeset
   if (env->complete) {
     env->local_aux= hashmap<string,tree> (UNINIT);
@@ -164,9 +168,18 @@ typesetter_rep::typeset () {
     env->redefined= array<tree> ();
     env->touched  = hashmap<string,bool> (false);
   }
+  if (!partial) par_limit= -1;
   br->typeset (PROCESSED+ WANTED_PARAGRAPH);
+  if (partial) br->status= CORRUPTED; // not all lines of br are in br->l
+  par_limit= -1;
   pager ppp= tm_new<pager_rep> (br->ip, env, l);
+  ppp->prev_l   = pages_prev_l;
+  ppp->prev_sk  = pages_prev_sk;
+  ppp->prev_pars= pages_prev_pars;
   box rb= ppp->make_pages ();
+  pages_prev_l   = ppp->prev_l;
+  pages_prev_sk  = ppp->prev_sk;
+  pages_prev_pars= ppp->prev_pars;
   if (env->complete && paper) determine_page_references (rb);
   tm_delete (ppp);
   // env->complete= false;  // moved to editor_rep::typeset
@@ -274,6 +287,12 @@ typeset (typesetter ttt, SI& x1, SI& y1, SI& x2, SI& y2) {
   return ttt->typeset (x1, y1, x2, y2);
 }
 
+box
+typeset_partial (typesetter ttt, int nr, SI& x1, SI& y1, SI& x2, SI& y2) {
+  ttt->par_limit= nr;
+  return ttt->typeset (x1, y1, x2, y2);
+}
+
 box
 typeset_as_document (edit_env env, tree t, path ip) {
   env->style_init_env ();
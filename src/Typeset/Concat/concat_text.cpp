@@ -402,7 +402,7 @@ concater_rep::typeset_repeat (tree t, path ip, bool under) {
   if (N(t) != 2) { typeset_error (t, ip); return; }
   box b1  = typeset_as_concat (env, t[0], descend (ip, 0));
   box b2  = typeset_as_concat (env, t[1], descend (ip, 1));
-  SI  xoff= env->get_length (XOFF_DECORATIONS);
+  SI  xoff= env->get_length (Slot_Xoff_Decorations);
   print (repeat_box (ip, b1, b2, xoff, under));
 }
 
@@ -495,7 +495,7 @@ void
 concater_rep::typeset_if_page_break (tree t, path ip) {
   if (N(t) != 2) { typeset_error (t, ip); return; }
   tree pos= env->exec (t[0]);
-  space spc= env->get_vspace (PAR_PAR_SEP);
+  space spc= env->get_vspace (Slot_Par_Par_Sep);
   tree sep= tree (TMLEN, as_string (spc->min),
                          as_string (spc->def), as_string (spc->max));
   tree ch= tuple ("if-page-break", pos, sep);
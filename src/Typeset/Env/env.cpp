@@ -17,6 +17,10 @@ extern hashmap<string,tree> default_env;
 void initialize_default_env ();
 #include "page_type.hpp"
 
+#ifdef TRACE_ENV_LOOKUPS
+array<string>* env_lookup_trace= NULL;
+#endif
+
 /******************************************************************************
 * Initialization
 ******************************************************************************/
@@ -30,7 +34,8 @@ edit_env_rep::edit_env_rep (drd_info& drd2,
 			    hashmap<string,tree>& local_att2,
 			    hashmap<string,tree>& global_att2):
   drd (drd2),
-  env (UNINIT), back (UNINIT), src (path (DECORATION)),
+  env (UNINIT), back (UNINIT), slot_env (NULL), slot_stamp (0),
+  src (path (DECORATION)),
   var_type (default_var_type),
   base_file_name (base_file_name2),
   cur_file_name (base_file_name2),
@@ -139,6 +144,40 @@ edit_env_rep::local_end_extents (tree t) {
   env ("t-length")= t[5];
 }
 
+/******************************************************************************
+* Slots for the most frequently read variables
+******************************************************************************/
+
+// The variables in the order of the Slot_* constants
+static string* slot_var[Env_Slots]= {
+  &FONT, &FONT_FAMILY, &FONT_SERIES, &FONT_SHAPE, &FONT_SIZE,
+  &FONT_BASE_SIZE, &FONT_EFFECTS, &MATH_FONT, &MATH_FONT_FAMILY,
+  &MATH_FONT_SERIES, &MATH_FONT_SHAPE, &PROG_FONT, &PROG_FONT_FAMILY,
+  &PROG_FONT_SERIES, &PROG_FONT_SHAPE, &MODE, &INFO_FLAG, &LANGUAGE,
+  &MATH_LANGUAGE, &PROG_LANGUAGE, &COLOR, &OPACITY, &LINE_WIDTH,
+  &NO_PATTERNS, &ZOOM_FACTOR, &MAGNIFICATION, &MAGNIFY, &LENGTH_MODE,
+  &MATH_LEVEL, &MATH_DISPLAY, &MATH_CONDENSED, &MATH_VPOS,
+  &MATH_NESTING_LEVEL, &PAR_MODE, &PAR_FLEXIBILITY, &PAR_HYPHEN,
+  &PAR_MIN_PENALTY, &PAR_LEFT, &PAR_RIGHT, &PAR_SEP, &PAR_HOR_SEP,
+  &PAR_VER_SEP, &PAR_LINE_SEP, &PAR_PAR_SEP, &PAR_COLUMNS, &PAR_SWELL,
+  &PAR_FIRST, &PAR_NO_FIRST, &PAR_KERNING_REDUCE, &PAR_KERNING_STRETCH,
+  &PAR_KERNING_MARGIN, &PAR_CONTRACTION, &PAR_EXPANSION, &PAR_SPACING,
+  &ATOM_DECORATIONS, &XOFF_DECORATIONS
+};
+
+void
+edit_env_rep::reset_slots () {
+  for (int i=0; i<Env_Slots; i++) slot[i]= NULL;
+  slot_env= env.operator -> ();
+  slot_stamp= env->stamp;
+}
+
+tree*
+edit_env_rep::locate_slot (int i) {
+  // variables which are not yet defined are looked up again next time
+  return slot[i]= env->locate (*slot_var[i]);
+}
+
 /******************************************************************************
 * Global manipulations of the environment
 ******************************************************************************/
@@ -156,23 +195,15 @@ edit_env_rep::write_env (hashmap<string,tree> user_env) {
 void
 edit_env_rep::monitored_patch_env (hashmap<string,tree> patch) {
   if (patch->size == 0) return;
-  int i=0, n=patch->n;
-  for (; i<n; i++) {
-    list<hashentry<string,tree> > l=patch->a[i];
-    for (; !is_nil(l); l=l->next)
-      monitored_write_update (l->item.key, l->item.im);
-  }
+  for (hashmap_entries<string,tree> e (patch); e.busy (); e.next ())
+    monitored_write_update (e->key, e->im);
 }
 
 void
 edit_env_rep::patch_env (hashmap<string,tree> patch) {
   if (patch->size == 0) return;
-  int i=0, n=patch->n;
-  for (; i<n; i++) {
-    list<hashentry<string,tree> > l=patch->a[i];
-    for (; !is_nil(l); l=l->next)
-      write_update (l->item.key, l->item.im);
-  }
+  for (hashmap_entries<string,tree> e (patch); e.busy (); e.next ())
+    write_update (e->key, e->im);
 }
 
 void
@@ -197,12 +228,8 @@ edit_env_rep::local_update (hashmap<string,tree>& old_patch,
 
 void
 edit_env_rep::local_end (hashmap<string,tree>& prev_back) {
-  int i=0, n=back->n;
-  for (; i<n; i++) {
-    list<hashentry<string,tree> > l=back->a[i];
-    for (; !is_nil(l); l=l->next)
-      prev_back->write_back (l->item.key, back);
-  }
+  for (hashmap_entries<string,tree> e (back); e.busy (); e.next ())
+    prev_back->write_back (e->key, back);
   back= prev_back;
 }
 
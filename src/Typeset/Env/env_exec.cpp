@@ -1225,7 +1225,7 @@ edit_env_rep::exec_use_package (tree t) {
     if (!load_string (name, doc_s, false)) {
       tree doc= texmacs_document_to_tree (doc_s);
       if (is_compound (doc))
-        exec (filter_style (extract (doc, "body")));
+        exec (intern (filter_style (extract (doc, "body"))));
     }
   }
   return "";
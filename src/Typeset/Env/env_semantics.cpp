@@ -289,7 +289,7 @@ edit_env_rep::get_page_pars (SI& w, SI& h, SI& width, SI& height,
   top   = page_top_margin;
   bot   = page_bottom_margin;
 
-  int nr_cols= get_int (PAR_COLUMNS);
+  int nr_cols= get_int (Slot_Par_Columns);
   if (nr_cols > 1) {
     double magn_old= magn_len;
     magn_len= 1.0;
@@ -549,31 +549,36 @@ edit_env_rep::get_script_size (int sz, int level) {
 
 void
 edit_env_rep::update_font () {
-  fn_size= (int) (((double) get_int (FONT_BASE_SIZE)) *
-		  get_double (FONT_SIZE) + 0.5);
+  fn_size= (int) (((double) get_int (Slot_Font_Base_Size)) *
+		  get_double (Slot_Font_Size) + 0.5);
   switch (mode) {
   case 0:
   case 1:
-    fn= smart_font (get_string (FONT), get_string (FONT_FAMILY),
-                    get_string (FONT_SERIES), get_string (FONT_SHAPE),
+    fn= smart_font (get_string (Slot_Font), get_string (Slot_Font_Family),
+                    get_string (Slot_Font_Series), get_string (Slot_Font_Shape),
                     get_script_size (fn_size, index_level), (int) (magn*dpi));
     break;
   case 2:
-    fn= smart_font (get_string (MATH_FONT), get_string (MATH_FONT_FAMILY),
-                    get_string (MATH_FONT_SERIES), get_string (MATH_FONT_SHAPE),
-                    get_string (FONT), get_string (FONT_FAMILY),
-                    get_string (FONT_SERIES), "mathitalic",
+    fn= smart_font (get_string (Slot_Math_Font),
+                    get_string (Slot_Math_Font_Family),
+                    get_string (Slot_Math_Font_Series),
+                    get_string (Slot_Math_Font_Shape),
+                    get_string (Slot_Font), get_string (Slot_Font_Family),
+                    get_string (Slot_Font_Series), "mathitalic",
                     get_script_size (fn_size, index_level), (int) (magn*dpi));
     break;
   case 3:
-    fn= smart_font (get_string (PROG_FONT), get_string (PROG_FONT_FAMILY),
-                    get_string (PROG_FONT_SERIES), get_string (PROG_FONT_SHAPE),
-                    get_string (FONT), get_string (FONT_FAMILY) * "-tt",
-                    get_string (FONT_SERIES), get_string (FONT_SHAPE),
+    fn= smart_font (get_string (Slot_Prog_Font),
+                    get_string (Slot_Prog_Font_Family),
+                    get_string (Slot_Prog_Font_Series),
+                    get_string (Slot_Prog_Font_Shape),
+                    get_string (Slot_Font),
+                    get_string (Slot_Font_Family) * "-tt",
+                    get_string (Slot_Font_Series), get_string (Slot_Font_Shape),
                     get_script_size (fn_size, index_level), (int) (magn*dpi));
     break;
   }
-  string eff= get_string (FONT_EFFECTS);
+  string eff= get_string (Slot_Font_Effects);
   if (N(eff) != 0) fn= apply_effects (fn, eff);
 }
 
@@ -597,13 +602,13 @@ decode_alpha (string s) {
 
 void
 edit_env_rep::update_color () {
-  alpha= decode_alpha (get_string (OPACITY));
-  tree pc= env [COLOR];
+  alpha= decode_alpha (get_string (Slot_Opacity));
+  tree pc= read (Slot_Color);
   tree fc= env [FILL_COLOR];
   if (pc == "none") pen= pencil (false);
   else {
     if (L(pc) == PATTERN) pc= exec (pc);
-    pen= pencil (pc, alpha, get_length (LINE_WIDTH));
+    pen= pencil (pc, alpha, get_length (Slot_Line_Width));
   }
   if (fc == "none") fill_brush= brush (false);
   else {
@@ -614,7 +619,7 @@ edit_env_rep::update_color () {
 
 void
 edit_env_rep::update_pattern_mode () {
-  no_patterns= (get_string (NO_PATTERNS) == "true");
+  no_patterns= (get_string (Slot_No_Patterns) == "true");
   if (no_patterns) {
     tree c= env[COLOR];
     if (is_func (c, PATTERN, 4)) env (COLOR)= exec (c);
@@ -632,7 +637,7 @@ edit_env_rep::update_pattern_mode () {
 
 void
 edit_env_rep::update_mode () {
-  string s= get_string (MODE);
+  string s= get_string (Slot_Mode);
   if (s == "text") mode=1;
   else if (s == "math") mode=2;
   else if (s == "prog") mode=3;
@@ -643,7 +648,7 @@ edit_env_rep::update_mode () {
 
 void
 edit_env_rep::update_info_level () {
-  string s= get_string (INFO_FLAG);
+  string s= get_string (Slot_Info_Flag);
   if (s == "none") info_level= INFO_NONE;
   else if (s == "minimal") info_level= INFO_MINIMAL;
   else if (s == "short") info_level= INFO_SHORT;
@@ -658,13 +663,13 @@ edit_env_rep::update_language () {
   switch (mode) {
   case 0:
   case 1:
-    lan= text_language (get_string (LANGUAGE));
+    lan= text_language (get_string (Slot_Language));
     break;
   case 2:
-    lan= math_language (get_string (MATH_LANGUAGE));
+    lan= math_language (get_string (Slot_Math_Language));
     break;
   case 3:
-    lan= prog_language (get_string (PROG_LANGUAGE));
+    lan= prog_language (get_string (Slot_Prog_Language));
     break;
   }
   hl_lan= lan->hl_lan;
@@ -935,15 +940,15 @@ edit_env_rep::update_line_arrows () {
 
 void
 edit_env_rep::update () {
-  zoomf          = normal_zoom (get_double (ZOOM_FACTOR));
+  zoomf          = normal_zoom (get_double (Slot_Zoom_Factor));
   pixel          = (SI) tm_round ((std_shrinkf * PIXEL) / zoomf);
-  magn           = get_double (MAGNIFICATION);
-  magn_len       = (get_string (LENGTH_MODE) == "fixed"? 1.0: magn);
-  index_level    = get_int (MATH_LEVEL);
-  display_style  = get_bool (MATH_DISPLAY);
-  math_condensed = get_bool (MATH_CONDENSED);
-  vert_pos       = get_int (MATH_VPOS);
-  nesting_level  = get_int (MATH_NESTING_LEVEL);
+  magn           = get_double (Slot_Magnification);
+  magn_len       = (get_string (Slot_Length_Mode) == "fixed"? 1.0: magn);
+  index_level    = get_int (Slot_Math_Level);
+  display_style  = get_bool (Slot_Math_Display);
+  math_condensed = get_bool (Slot_Math_Condensed);
+  vert_pos       = get_int (Slot_Math_Vpos);
+  nesting_level  = get_int (Slot_Math_Nesting_Level);
   preamble       = get_bool (PREAMBLE);
   spacing_policy = get_spacing_id (env[SPACING_POLICY]);
   math_font_sizes= env[MATH_FONT_SIZES];
@@ -980,7 +985,8 @@ edit_env_rep::update () {
 
   frac_max   = get_length (MATH_FRAC_LIMIT);
   table_max  = get_length (MATH_TABLE_LIMIT);
-  flatten_pen= pencil (env[MATH_FLATTEN_COLOR], alpha, get_length (LINE_WIDTH));
+  flatten_pen= pencil (env[MATH_FLATTEN_COLOR], alpha,
+                       get_length (Slot_Line_Width));
 }
 
 /******************************************************************************
@@ -995,18 +1001,18 @@ edit_env_rep::update (string s) {
   case Env_Fixed:
     break;
   case Env_Zoom:
-    zoomf= normal_zoom (get_double (ZOOM_FACTOR));
+    zoomf= normal_zoom (get_double (Slot_Zoom_Factor));
     pixel= (SI) tm_round ((std_shrinkf * PIXEL) / zoomf);
     break;
   case Env_Magnification:
-    magn= get_double (MAGNIFICATION);
-    magn_len= (get_string (LENGTH_MODE) == "fixed"? 1.0: magn);
+    magn= get_double (Slot_Magnification);
+    magn_len= (get_string (Slot_Length_Mode) == "fixed"? 1.0: magn);
     update_font ();
     update_color ();
     update_dash_style_unit ();
     break;
   case Env_Magnify:
-    mgfy= get_double (MAGNIFY);
+    mgfy= get_double (Slot_Magnify);
     update_font ();
     update_color ();
     update_dash_style_unit ();
@@ -1034,25 +1040,26 @@ edit_env_rep::update (string s) {
     update_font ();
     break;
   case Env_Index_Level:
-    index_level= get_int (MATH_LEVEL);
+    index_level= get_int (Slot_Math_Level);
     update_font ();
     break;
   case Env_Display_Style:
-    display_style= get_bool (MATH_DISPLAY);
+    display_style= get_bool (Slot_Math_Display);
     break;
   case Env_Math_Condensed:
-    math_condensed= get_bool (MATH_CONDENSED);
+    math_condensed= get_bool (Slot_Math_Condensed);
     break;
   case Env_Vertical_Pos:
-    vert_pos= get_int (MATH_VPOS);
+    vert_pos= get_int (Slot_Math_Vpos);
     break;
   case Env_Math_Nesting:
-    nesting_level= get_int (MATH_NESTING_LEVEL);
+    nesting_level= get_int (Slot_Math_Nesting_Level);
     break;
   case Env_Math_Width:
     frac_max= get_length (MATH_FRAC_LIMIT);
     table_max= get_length (MATH_TABLE_LIMIT);
-    flatten_pen= pencil (env[MATH_FLATTEN_COLOR], alpha, get_length (LINE_WIDTH));
+    flatten_pen= pencil (env[MATH_FLATTEN_COLOR], alpha,
+                         get_length (Slot_Line_Width));
     break;
   case Env_Color:
     update_color ();
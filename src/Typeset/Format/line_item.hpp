@@ -70,4 +70,20 @@ CONCRETE_NULL_CODE(line_item);
 
 tm_ostream& operator << (tm_ostream& out, line_item item);
 
+struct line_breaking_problem {
+  array<line_item> a;      // the line items of the paragraph
+  int   start, end;        // the range of items to be broken into lines
+  SI    line_width;        // the width of the lines, including the tolerance
+  SI    large_width;       // the width above which lines are overfull
+  SI    first_spc;         // extra space at the start of the first line
+  SI    last_spc;          // extra space at the end of the last line
+};
+
+// when set, the justified line breaking problems which are solved during
+// typesetting are appended to this array (used for comparing breakers)
+extern array<line_breaking_problem>* line_breaking_trace;
+
+void set_new_line_breaking (bool new_val);
+bool get_new_line_breaking ();
+
 #endif // defined LINE_ITEM_H
@@ -33,33 +33,33 @@ lazy_paragraph_rep::lazy_paragraph_rep (edit_env env2, path ip):
   env (env2), style (""), sss (tm_new<stacker_rep> ())
 {
   sss->ip= ip; // is this necessary?
-  style (PAR_FIRST)   = env->read (PAR_FIRST);
-  style (PAR_NO_FIRST)= env->read (PAR_NO_FIRST);
+  style (PAR_FIRST)   = env->read (Slot_Par_First);
+  style (PAR_NO_FIRST)= env->read (Slot_Par_No_First);
   // env->assign (PAR_NO_FIRST, "false");
   env->monitored_write_update (PAR_NO_FIRST, "false");
 
   SI d1, d2, d3, d4, d5, d6, d7;
   env->get_page_pars (width, d1, d2, d3, d4, d5, d6, d7);
 
-  mode       = as_string (env->read (PAR_MODE));
-  flexibility= as_double (env->read (PAR_FLEXIBILITY));
-  hyphen     = as_string (env->read (PAR_HYPHEN));
-  min_pen    = as_double (env->read (PAR_MIN_PENALTY));
-  left       = env->get_length (PAR_LEFT);
-  right      = env->get_length (PAR_RIGHT);
+  mode       = as_string (env->read (Slot_Par_Mode));
+  flexibility= as_double (env->read (Slot_Par_Flexibility));
+  hyphen     = as_string (env->read (Slot_Par_Hyphen));
+  min_pen    = as_double (env->read (Slot_Par_Min_Penalty));
+  left       = env->get_length (Slot_Par_Left);
+  right      = env->get_length (Slot_Par_Right);
   bot        = 0;
   top        = env->fn->yx;
-  sep        = env->get_length (PAR_SEP);
-  hor_sep    = env->get_length (PAR_HOR_SEP);
-  ver_sep    = env->get_length (PAR_VER_SEP);
+  sep        = env->get_length (Slot_Par_Sep);
+  hor_sep    = env->get_length (Slot_Par_Hor_Sep);
+  ver_sep    = env->get_length (Slot_Par_Ver_Sep);
   height     = env->as_length (string ("1fn"))+ sep;
   tab_sep    = hor_sep;
-  line_sep   = env->get_vspace (PAR_LINE_SEP);
-  par_sep    = env->get_vspace (PAR_PAR_SEP);
-  nr_cols    = env->get_int (PAR_COLUMNS);
+  line_sep   = env->get_vspace (Slot_Par_Line_Sep);
+  par_sep    = env->get_vspace (Slot_Par_Par_Sep);
+  nr_cols    = env->get_int (Slot_Par_Columns);
   swell      = array<SI> ();
 
-  SI sw= env->get_length (PAR_SWELL);
+  SI sw= env->get_length (Slot_Par_Swell);
   if (sw > 0)
     swell << sw
           << env->get_length (MATH_TOP_SWELL_START)
@@ -67,12 +67,12 @@ lazy_paragraph_rep::lazy_paragraph_rep (edit_env env2, path ip):
           << env->get_length (MATH_BOT_SWELL_START)
           << env->get_length (MATH_BOT_SWELL_END);
 
-  string kr= as_string (env->read (PAR_KERNING_REDUCE));
+  string kr= as_string (env->read (Slot_Par_Kerning_Reduce));
   if (kr == "auto") kreduce= 0.4 / 40.0;
   else if (is_double (kr)) kreduce= as_double (kr);
   else kreduce= 0.0;
 
-  string ks= as_string (env->read (PAR_KERNING_STRETCH));
+  string ks= as_string (env->read (Slot_Par_Kerning_Stretch));
   if (ks == "auto") {
     double cpl= min (max (((double) width) / max (env->fn->wfn, 1), 10.0), 40.0);
     kstretch= 1.0 / cpl;
@@ -84,16 +84,16 @@ lazy_paragraph_rep::lazy_paragraph_rep (edit_env env2, path ip):
   else if (is_double (ks)) kstretch= as_double (ks);
   else kstretch= 0.0;
 
-  string ps= as_string (env->read (PAR_KERNING_MARGIN));
+  string ps= as_string (env->read (Slot_Par_Kerning_Margin));
   if (ps == "true") protrusion= WESTERN_PROTRUSION;
   else protrusion= 0;
 
-  string cf= as_string (env->read (PAR_CONTRACTION));
+  string cf= as_string (env->read (Slot_Par_Contraction));
   if (cf == "auto") contraction= 1.0 / 40.0;
   else if (is_double (cf)) contraction= as_double (cf);
   else contraction= 0.0;
 
-  string ef= as_string (env->read (PAR_EXPANSION));
+  string ef= as_string (env->read (Slot_Par_Expansion));
   if (ef == "auto") {
     double cpl= min (max (((double) width) / max (env->fn->wfn, 1), 10.0), 40.0);
     expansion= 0.7 / cpl;
@@ -110,14 +110,14 @@ lazy_paragraph_rep::lazy_paragraph_rep (edit_env env2, path ip):
   //contraction= kreduce= 0.0; // FIXME
   //expansion= contraction= 0.0; // FIXME
 
-  string sm= as_string (env->read (PAR_SPACING));
+  string sm= as_string (env->read (Slot_Par_Spacing));
   if (sm == "plain");
   else if (sm == "quanjiao") protrusion += QUANJIAO;
   else if (sm == "banjiao") protrusion += BANJIAO;
   else if (sm == "hangmobanjiao") protrusion += HANGMOBANJIAO;
   else if (sm == "kaiming") protrusion += KAIMING;
 
-  tree dec= env->read (ATOM_DECORATIONS);
+  tree dec= env->read (Slot_Atom_Decorations);
   if (N(dec) > 0) decs << tuple ("0", dec);
 }
 
@@ -915,5 +915,5 @@ lazy_paragraph_rep::produce (lazy_type request, format fm) {
 
 void
 lazy_paragraph_rep::propagate () {
-  style (PAR_NO_FIRST)= env->read (PAR_NO_FIRST);
+  style (PAR_NO_FIRST)= env->read (Slot_Par_No_First);
 }
@@ -447,6 +447,356 @@ line_breaker_rep::compute_breaks () {
   return ap;
 }
 
+/******************************************************************************
+* Line breaking with a list of active breaks
+*******************************************************************************
+* The active_breaker_rep class computes the same breaks as line_breaker_rep,
+* but sweeps only once over the line items.  A break is active as long as
+* a line starting at it might still end at the current item.  For each item,
+* the active breaks propose the breaks at or after it in the same order as
+* line_breaker_rep::process, so that ties are resolved in the same way.
+* The widths of the lines are differences of prefix sums, the breaks are
+* stored in arrays indexed by integers instead of hashmaps indexed by paths,
+* and the remainder of a hyphenated item is only computed once.
+******************************************************************************/
+
+struct active_breaker_rep {
+  array<line_item> a;
+  int start;
+  int end;
+  SI  line_width;
+  SI  large_width;
+  SI  first_spc;
+  SI  last_spc;
+  int pass;
+
+  array<DI> sum_min;          // prefix sums of the minimal widths
+  array<DI> sum_def;          // prefix sums of the default widths
+  array<DI> sum_max;          // prefix sums of the maximal widths
+  array<array<int> > hp;      // hyphenation penalties of the items
+  array<array<SI> >  hw;      // widths of the hyphenated beginnings
+                              // or MINUS_INFINITY if not yet computed
+
+  array<path> pos;            // the positions of the breaks
+  array<int>  parent;         // for breaks inside hyphenated items
+  array<line_item> first;     // the (remainder of the) item at the break
+  array<SI>   base;           // width of the line until the next item
+  array<int>  prev;           // the best previous break
+  array<int>  pen;            // the best penalty
+  array<PEN>  pen_spc;        // the best spacing penalty
+  array<bool> defined;        // did we propose this break?
+  array<array<int> > sub;     // hyphenated breaks at this break
+  array<int>  active;         // the active breaks
+
+  active_breaker_rep (array<line_item> a, int start, int end,
+		      SI line_width, SI large_width,
+                      SI first_spc, SI last_spc);
+
+  inline int atom (int i) { return i - start; }
+  int  new_break (path p, int par);
+  int  hyph_break (int par, int j);
+  void hyphenations (int i);
+  SI   hyphen_width (int i, int j);
+  void test_better (int nr, int old_nr, int penalty, PEN pen_spc);
+  bool propose_break (int nr, int old_nr, int penalty,
+                      SI spc_min, SI spc_def, SI spc_max);
+  void break_string (line_item item, int nr, int i,
+                     SI spc_min, SI spc_def, SI spc_max);
+  bool step (int nr, int i);
+  void visit (int nr, int i, array<int>& next);
+  void sweep ();
+  array<path> compute_breaks ();
+};
+
+active_breaker_rep::active_breaker_rep (
+  array<line_item> a2, int start2, int end2,
+  SI line_width2, SI large_width2, SI first_spc2, SI last_spc2):
+    a (a2), start (start2), end (end2),
+    line_width (line_width2), large_width (large_width2),
+    first_spc (first_spc2), last_spc (last_spc2)
+{
+  int i, n= end - start;
+  sum_min= array<DI> (n);
+  sum_def= array<DI> (n);
+  sum_max= array<DI> (n);
+  for (i=start; i<end; i++) {
+    if (i == start) {
+      sum_min[0]= sum_def[0]= sum_max[0]= 0;
+      continue;
+    }
+    space spc= a[i-1]->spc;
+    SI    w  = a[i]->b->w();
+    sum_min[i-start]= sum_min[i-start-1] + spc->min + w;
+    sum_def[i-start]= sum_def[i-start-1] + spc->def + w;
+    sum_max[i-start]= sum_max[i-start-1] + spc->max + w;
+  }
+  hp= array<array<int> > (n);
+  hw= array<array<SI> > (n);
+  for (i=start; i<=end; i++)
+    (void) new_break (path (i), -1);
+}
+
+/******************************************************************************
+* Creation of breaks
+******************************************************************************/
+
+int
+active_breaker_rep::new_break (path p, int par) {
+  int nr= N(pos);
+  pos     << p;
+  parent  << par;
+  first   << (par < 0 && p->item < end? a[p->item]: line_item ());
+  base    << 0;
+  prev    << -1;
+  pen     << HYPH_INVALID;
+  pen_spc << ((PEN) 1000000000);
+  defined << false;
+  sub     << array<int> ();
+  return nr;
+}
+
+int
+active_breaker_rep::hyph_break (int par, int j) {
+  // Return the break inside the remainder of the item at par
+  array<int>& s= sub[par];
+  if (j < N(s) && s[j] >= 0) return s[j];
+  int k, n= N(s);
+  if (j >= n) {
+    s->resize (j+1);
+    for (k=n; k<=j; k++) s[k]= -1;
+  }
+  int nr= new_break (pos[par] * j, par);
+  sub[par][j]= nr;
+  return nr;
+}
+
+static SI
+hyphen_width (line_item item, int j) {
+  line_item item1, item2;
+  hyphenate (item, j, item1, item2);
+  return item1->b->w();
+}
+
+SI
+active_breaker_rep::hyphen_width (int i, int j) {
+  // Width of the beginning of a[i] when hyphenating at j
+  SI& w= hw[i-start][j];
+  if (w == MINUS_INFINITY) w= ::hyphen_width (a[i], j);
+  return w;
+}
+
+void
+active_breaker_rep::hyphenations (int i) {
+  // Hyphenation penalties of a[i]
+  if (N (hp[i-start]) != 0) return;
+  line_item item= a[i];
+  array<int> h= item->lan->get_hyphens (item->b->get_leaf_string ());
+  array<SI>  w (N(h));
+  for (int j=0; j<N(h); j++) w[j]= MINUS_INFINITY;
+  hp[i-start]= h;
+  hw[i-start]= w;
+}
+
+/******************************************************************************
+* Proposing breaks
+******************************************************************************/
+
+void
+active_breaker_rep::test_better (int nr, int old_nr, int pen2, PEN pen_spc2) {
+  defined[nr]= true;
+  if ((pen2 < pen[nr]) ||
+      ((pen2 == pen[nr]) && (pen_spc2 < pen_spc[nr]))) {
+    prev   [nr]= old_nr;
+    pen    [nr]= pen2;
+    pen_spc[nr]= min (pen_spc2, (PEN) 1000000000);
+  }
+}
+
+bool
+active_breaker_rep::propose_break (int nr, int old_nr, int pen2,
+				   SI spc_min, SI spc_def, SI spc_max)
+{
+  int  cur_pen    = pen[old_nr];
+  PEN  cur_pen_spc= pen_spc[old_nr];
+  bool at_end     = (pos[nr]->item == end);
+  bool same_item  = (pos[nr]->item == pos[old_nr]->item);
+
+  if ((spc_min <= line_width) && ((spc_max >= line_width) || at_end)) {
+    SI d= max (line_width- spc_def, spc_def- line_width);
+    if (at_end) d=0;
+    test_better (nr, old_nr, min (HYPH_INVALID, cur_pen + pen2),
+		 cur_pen_spc + (cur_pen == HYPH_INVALID?
+                                ((PEN) 0): square ((PEN) (d / PIXEL))));
+  }
+
+  if (pass==2) {
+    if (spc_max < line_width)
+      test_better (nr, old_nr, HYPH_INVALID,
+		   (cur_pen == HYPH_INVALID? cur_pen_spc: ((PEN) 0)) +
+		   square ((PEN) ((line_width - spc_max)/PIXEL)) +
+		   (same_item? square ((PEN) (line_width / PIXEL)): ((PEN) 0)));
+    else if (spc_min > large_width)
+      test_better (nr, old_nr, HYPH_INVALID,
+		   (cur_pen == HYPH_INVALID? cur_pen_spc: ((PEN) 0)) +
+		   square ((PEN) ((spc_min - line_width) / PIXEL)) +
+		   square ((PEN) (4*line_width / PIXEL)));
+    else if (spc_min > line_width)
+      test_better (nr, old_nr, HYPH_INVALID,
+		   (cur_pen == HYPH_INVALID? cur_pen_spc: ((PEN) 0)) +
+		   square ((PEN) ((spc_min - line_width) / PIXEL)) +
+		   (same_item? square ((PEN) (line_width / PIXEL)): ((PEN) 0)));
+  }
+
+  return spc_min > large_width;
+}
+
+void
+active_breaker_rep::break_string (line_item item, int nr, int i,
+				  SI spc_min, SI spc_def, SI spc_max)
+{
+  // The hyphenations of the remainders of hyphenated items are not cached
+  int  j, at= (i == pos[nr]->item? nr: atom (i));
+  bool cached= (parent[at] < 0);
+  array<int> h;
+  if (cached) {
+    hyphenations (i);
+    h= hp[i-start];
+  }
+  else h= item->lan->get_hyphens (item->b->get_leaf_string ());
+
+  if ((item->b->w() > line_width) || (parent[nr] >= 0)) {
+    string item_s= item->b->get_leaf_string ();
+    j= get_position (item->b->get_leaf_font (), item_s, line_width- spc_def);
+    for (j= min (j+2, N(h)-1); j>=0; j--)
+      if (h[j] < HYPH_INVALID) {
+        SI w= (cached? hyphen_width (i, j): ::hyphen_width (item, j));
+	if (spc_min + w <= line_width) {
+          w += spc_min;
+	  propose_break (hyph_break (at, j), nr, h[j], w, w, w);
+	  break;
+	}
+      }
+  }
+  else {
+    for (j=0; j<N(h); j++)
+      if (h[j] < HYPH_INVALID) {
+        SI w= (cached? hyphen_width (i, j): ::hyphen_width (item, j));
+	(void) propose_break (hyph_break (at, j), nr, h[j],
+                              spc_min + w, spc_def + w, spc_max + w);
+      }
+  }
+}
+
+/******************************************************************************
+* Sweeping over the line items
+******************************************************************************/
+
+bool
+active_breaker_rep::step (int nr, int i) {
+  // Propose the breaks at the i-th item for lines starting at nr.
+  // Return true if no line starting at nr can extend beyond this item
+  int  at  = pos[nr]->item;
+  line_item item= (i == at? first[nr]: a[i]);
+  SI   w   = item->b->w();
+  SI   spc_min= base[nr], spc_def= base[nr], spc_max= base[nr];
+  if (i != at) {
+    spc_min += (SI) (sum_min[i-start] - sum_min[at-start]);
+    spc_def += (SI) (sum_def[i-start] - sum_def[at-start]);
+    spc_max += (SI) (sum_max[i-start] - sum_max[at-start]);
+  }
+
+  if ((spc_max > line_width) &&
+      (item->type == STRING_ITEM) &&
+      (N(item->b->get_leaf_string ())>4))
+    break_string (item, nr, i, spc_min - w, spc_def - w, spc_max - w);
+  if (item->penalty < HYPH_INVALID)
+    if (propose_break (atom (i+1), nr, item->penalty,
+                       spc_min, spc_def, spc_max))
+      return true;
+  if ((item->type == CONTROL_ITEM) &&
+      (item->t == LINE_BREAK) &&
+      (spc_min < line_width))
+    if (propose_break (atom (i+1), nr, 0,
+                       line_width, line_width, line_width))
+      return true;
+  if (i+1 == end) {
+    line_width -= last_spc;
+    propose_break (atom (end), nr, 0, spc_min, spc_def, spc_max);
+    line_width += last_spc;
+  }
+  return false;
+}
+
+void
+active_breaker_rep::visit (int nr, int i, array<int>& next) {
+  // Start the lines at the break nr and the breaks inside its remainder
+  if (parent[nr] >= 0 && is_nil (first[nr])) {
+    line_item item1, item2;
+    hyphenate (first[parent[nr]], last_item (pos[nr]), item1, item2);
+    first[nr]= item2;
+  }
+  line_item item= first[nr];
+  if (parent[nr] < 0 && i == start) base[nr]= first_spc + item->b->w();
+  else base[nr]= item->b->w();
+
+  if ((pass>1) || (pen[nr] < HYPH_INVALID))
+    if (!step (nr, i)) next << nr;
+
+  if (item->type == STRING_ITEM) {
+    int j, n= N(item->b->get_leaf_string ());
+    if (n>4)
+      for (j=0; j<n-1 && j<N(sub[nr]); j++) {
+        int s= sub[nr][j];
+	if (s >= 0 && defined[s])
+	  visit (s, i, next);
+      }
+  }
+}
+
+void
+active_breaker_rep::sweep () {
+  active= array<int> ();
+  for (int i=start; i<end; i++) {
+    array<int> next;
+    for (int k=0; k<N(active); k++)
+      if (!step (active[k], i)) next << active[k];
+    visit (atom (i), i, next);
+    active= next;
+  }
+}
+
+array<path>
+active_breaker_rep::compute_breaks () {
+  int i;
+  test_better (atom (start), -1, 0, 0);
+
+  pass= 1;
+  sweep ();
+
+  pass= 2;
+  if (pen[atom (end)] == HYPH_INVALID)
+    sweep ();
+
+  test_better (atom (end), atom (start), HYPH_INVALID, (PEN) 999999999);
+
+  array<path> ap (0);
+  for (i= atom (end); i >= 0; i= prev[i]) ap << pos[i];
+  for (i=0; i < (N(ap)>>1); i++) {
+    path p= ap[i];
+    ap[i]= ap[N(ap)-1-i];
+    ap[N(ap)-1-i]= p;
+  }
+
+  // Finish with fix for disallowing last lines with only empty boxes
+  if (N(ap) <= 2 || !is_atom (ap[N(ap)-2])) return ap;
+  for (i= ap[N(ap)-2]->item; i<end; i++)
+    if (a[i]->b->w() + a[i]->spc->def != 0)
+      return ap;
+  ap[N(ap)-2]= ap[N(ap)-1];
+  ap->resize (N(ap)-1);
+  return ap;
+}
+
 /******************************************************************************
 * The exported line breaking routine
 *******************************************************************************
@@ -458,6 +808,40 @@ line_breaker_rep::compute_breaks () {
 * the line_item, if it was a STRING_ITEM.
 ******************************************************************************/
 
+array<line_breaking_problem>* line_breaking_trace= NULL;
+
+// the "new style line breaking" preference, set by the preference hook,
+// since it is needed for every paragraph
+static bool new_line_breaking= true;
+void set_new_line_breaking (bool new_val) { new_line_breaking= new_val; }
+bool get_new_line_breaking () { return new_line_breaking; }
+
+array<path>
+classic_line_breaks (array<line_item> a, int start, int end,
+                     SI line_width, SI large_width,
+                     SI first_spc, SI last_spc)
+{
+  line_breaker_rep* H=
+    tm_new<line_breaker_rep> (a, start, end, line_width, large_width,
+                              first_spc, last_spc);
+  array<path> ap= H->compute_breaks ();
+  tm_delete (H);
+  return ap;
+}
+
+array<path>
+active_line_breaks (array<line_item> a, int start, int end,
+                    SI line_width, SI large_width,
+                    SI first_spc, SI last_spc)
+{
+  active_breaker_rep* H=
+    tm_new<active_breaker_rep> (a, start, end, line_width, large_width,
+                                first_spc, last_spc);
+  array<path> ap= H->compute_breaks ();
+  tm_delete (H);
+  return ap;
+}
+
 array<path>
 line_breaks (array<line_item> a, int start, int end,
 	     SI line_width, SI large_width,
@@ -465,10 +849,22 @@ line_breaks (array<line_item> a, int start, int end,
 {
   int tol= 5;         // extra tolerance of 5tmpt avoid rounding errors when
   line_width += tol;  // the widths of the boxes sum up to precisely 1par
-  line_breaker_rep* H=
-    tm_new<line_breaker_rep> (a, start, end, line_width, large_width,
+  if (ragged) {
+    line_breaker_rep* H=
+      tm_new<line_breaker_rep> (a, start, end, line_width, large_width,
+                                first_spc, last_spc);
+    array<path> ap= H->compute_ragged_breaks ();
+    tm_delete (H);
+    return ap;
+  }
+  if (line_breaking_trace != NULL) {
+    line_breaking_problem lb= { a, start, end, line_width, large_width,
+                                first_spc, last_spc };
+    (*line_breaking_trace) << lb;
+  }
+  if (new_line_breaking)
+    return active_line_breaks (a, start, end, line_width, large_width,
+                               first_spc, last_spc);
+  return classic_line_breaks (a, start, end, line_width, large_width,
                               first_spc, last_spc);
-  array<path> ap= ragged? H->compute_ragged_breaks (): H->compute_breaks ();
-  tm_delete (H);
-  return ap;
 }
@@ -16,16 +16,25 @@
 box format_stack (path ip, array<box> bx, array<space> ht, SI height,
 		  bool may_stretch);
 #include "Boxes/construct.hpp"
+#include "boot.hpp"
 array<page_item> sub (array<page_item> l, path p, path q);
 page_item access (array<page_item> l, path p);
 space as_space (tree t);
 skeleton break_pages (array<page_item> l, space ph, int qual,
 		      space fn_sep, space fnote_sep, space float_sep,
                       font fn, int first_page);
+skeleton break_pages (array<page_item> l, space ph, int qual,
+		      space fn_sep, space fnote_sep, space float_sep,
+                      font fn, int first_page,
+                      skeleton prev_sk, int prev_n, int start, int end);
+void changed_page_items (array<page_item> l1, array<page_item> l2,
+                         int& start, int& end);
 box page_box (path ip, box b, tree page, int page_nr, brush bgc,
               SI width, SI height, SI left, SI top,
 	      SI bot, box header, box footer, SI head_sep, SI foot_sep);
 
+array<page_breaking_problem>* page_breaking_trace= NULL;
+
 box
 pager_rep::pages_format (array<page_item> l, SI ht, SI tcor, SI bcor) {
   // cout << "Formatting insertion of height " << ht << LF;
@@ -195,12 +204,45 @@ pager_rep::pages_make_page (pagelet pg) {
   return crop_marks_box (ip, page, w, h, lw, ll);
 }
 
+static string
+as_string (space spc) {
+  return as_string (spc->min) * "," * as_string (spc->def) * "," *
+         as_string (spc->max);
+}
+
 void
 pager_rep::pages_make () {
   space ht (text_height- may_shrink, text_height, text_height+ may_extend);
-  skeleton sk=
-    break_pages (l, ht, quality, fn_sep, fnote_sep, float_sep,
-                 env->fn, env->first_page);
+  string pars= as_string (ht) * ";" * as_string (quality) * ";" *
+    as_string (fn_sep) * ";" * as_string (fnote_sep) * ";" *
+    as_string (float_sep) * ";" * env->fn->res_name * ";" *
+    as_string (env->first_page) * ";" *
+    get_user_preference ("new style page breaking");
+  if (page_breaking_trace != NULL) {
+    page_breaking_problem pb;
+    pb.l         = copy (l);
+    pb.ht        = ht;
+    pb.quality   = quality;
+    pb.fn_sep    = fn_sep;
+    pb.fnote_sep = fnote_sep;
+    pb.float_sep = float_sep;
+    pb.fn        = env->fn;
+    pb.first_page= env->first_page;
+    (*page_breaking_trace) << pb;
+  }
+  skeleton sk;
+  if ((N(prev_sk) != 0) && (pars == prev_pars)) {
+    int start, end;
+    changed_page_items (prev_l, l, start, end);
+    sk= break_pages (l, ht, quality, fn_sep, fnote_sep, float_sep,
+                     env->fn, env->first_page,
+                     prev_sk, N(prev_l), start, end);
+  }
+  else sk= break_pages (l, ht, quality, fn_sep, fnote_sep, float_sep,
+                        env->fn, env->first_page);
+  prev_l   = l;
+  prev_sk  = sk;
+  prev_pars= pars;
   int i, n= N(sk);
   for (i=0; i<n; i++)
     pages << pages_make_page (sk[i]);
@@ -725,11 +725,12 @@ new_breaker_rep::assemble_skeleton (skeleton& sk, path end, int& offset) {
 skeleton
 new_break_pages (array<page_item> l, space ph, int qual,
                  space fn_sep, space fnote_sep, space float_sep,
-                 font fn, int first_page)
+                 font fn, int first_page, bool last)
 {
   new_breaker_rep* H=
     tm_new<new_breaker_rep> (l, ph, qual, fn_sep, fnote_sep, float_sep,
                              fn, first_page);
+  H->last_page_flag= last;
   //cout << HRULE << LF;
   H->find_page_breaks ();
   //cout << HRULE << LF;
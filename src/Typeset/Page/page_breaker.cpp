@@ -135,7 +135,7 @@ struct page_breaker_rep {
   void assemble_skeleton (skeleton& sk, int last);
   void assemble_skeleton (skeleton& sk);
   void assemble_skeleton (skeleton& sk, int start, int end);
-  skeleton make_skeleton ();
+  skeleton make_skeleton (bool last= true);
 };
 
 /******************************************************************************
@@ -1464,7 +1464,7 @@ page_breaker_rep::assemble_skeleton (skeleton& sk, int start, int end) {
 }
 
 skeleton
-page_breaker_rep::make_skeleton () {
+page_breaker_rep::make_skeleton (bool last) {
   skeleton sk;
   int i, j, n= N(l);
   bool dpage_flag= false;
@@ -1488,35 +1488,304 @@ page_breaker_rep::make_skeleton () {
   if (i<j) {
     if (dpage_flag && ((N(sk)&1) == 1))
       sk << pagelet (space (0));
-    last_page_flag= true;
+    last_page_flag= last;
     assemble_skeleton (sk, i, j);
   }
   return sk;
 }
 
 /******************************************************************************
-* The exported page breaking routine
+* The exported page breaking routines
 ******************************************************************************/
 
 skeleton new_break_pages (array<page_item> l, space ph, int qual,
                           space fn_sep, space fnote_sep, space float_sep,
-                          font fn, int first_page);
+                          font fn, int first_page, bool last);
 
 skeleton
+classic_break_pages (array<page_item> l, space ph, int qual,
+                     space fn_sep, space fnote_sep, space float_sep,
+                     font fn, int first_page, bool last)
+{
+  page_breaker_rep* H=
+    tm_new<page_breaker_rep> (l, ph, qual, fn_sep, fnote_sep, float_sep,
+                              fn, first_page);
+  // cout << HRULE << LF;
+  skeleton sk= H->make_skeleton (last);
+  tm_delete (H);
+  return sk;
+}
+
+static skeleton
 break_pages (array<page_item> l, space ph, int qual,
 	     space fn_sep, space fnote_sep, space float_sep,
-             font fn, int first_page)
+             font fn, int first_page, bool last)
 {
   if (get_user_preference ("new style page breaking") != "off")
     return new_break_pages (l, ph, qual, fn_sep, fnote_sep, float_sep,
-                            fn, first_page);
-  else {
-    page_breaker_rep* H=
-      tm_new<page_breaker_rep> (l, ph, qual, fn_sep, fnote_sep, float_sep,
-                                fn, first_page);
-    // cout << HRULE << LF;
-    skeleton sk= H->make_skeleton ();
-    tm_delete (H);
-    return sk;
+                            fn, first_page, last);
+  else
+    return classic_break_pages (l, ph, qual, fn_sep, fnote_sep, float_sep,
+                                fn, first_page, last);
+}
+
+skeleton
+break_pages (array<page_item> l, space ph, int qual,
+	     space fn_sep, space fnote_sep, space float_sep,
+             font fn, int first_page)
+{
+  return break_pages (l, ph, qual, fn_sep, fnote_sep, float_sep,
+                      fn, first_page, true);
+}
+
+/******************************************************************************
+* Incremental page breaking
+*******************************************************************************
+* When only the page items in a range [start, end) changed with respect to
+* a previous page breaking, we keep the previous pages before start and
+* only break the pages in a window which starts at the last old page break
+* before start.  The window is enlarged until the new page breaks meet an
+* old page break after end, at which point we continue with the old pages.
+* We only synchronize at 'clean' page breaks, which are not crossed by any
+* footnotes or floats, so that both page breakings have the same (empty)
+* sets of pending insertions at the synchronization point.
+******************************************************************************/
+
+static bool
+same_page_item (page_item item1, page_item item2) {
+  if (item1 == item2) return true;
+  if ((item1->type    != item2->type   ) ||
+      (item1->b       != item2->b      ) ||
+      (item1->spc     != item2->spc    ) ||
+      (item1->penalty != item2->penalty) ||
+      (item1->nr_cols != item2->nr_cols) ||
+      (item1->t       != item2->t      ) ||
+      (N(item1->fl)   != N(item2->fl)  )) return false;
+  int i, n= N(item1->fl);
+  for (i=0; i<n; i++)
+    if (item1->fl[i] != item2->fl[i]) return false;
+  return true;
+}
+
+void
+changed_page_items (array<page_item> l1, array<page_item> l2,
+                    int& start, int& end)
+{
+  int n1= N(l1), n2= N(l2), k= 0;
+  start= 0;
+  while ((start < n1) && (start < n2) && same_page_item (l1[start], l2[start]))
+    start++;
+  while ((k < n1 - start) && (k < n2 - start) &&
+         same_page_item (l1[n1-1-k], l2[n2-1-k]))
+    k++;
+  end= n2 - k;
+}
+
+static path
+shift_items (path p, int d) {
+  if (is_nil (p)) return p;
+  return path (p->item + d, p->next);
+}
+
+static pagelet shift_items (pagelet pg, int d);
+
+static insertion
+shift_items (insertion ins, int d) {
+  insertion r (ins->type, shift_items (ins->begin, d),
+               shift_items (ins->end, d));
+  int i, n= N(ins->sk);
+  for (i=0; i<n; i++) r->sk << shift_items (ins->sk[i], d);
+  r->ht     = ins->ht;
+  r->xh     = ins->xh;
+  r->pen    = ins->pen;
+  r->stretch= ins->stretch;
+  r->top_cor= ins->top_cor;
+  r->bot_cor= ins->bot_cor;
+  r->nr_cols= ins->nr_cols;
+  return r;
+}
+
+static pagelet
+shift_items (pagelet pg, int d) {
+  if (d == 0) return pg;
+  pagelet r (pg->ht);
+  r->pen    = pg->pen;
+  r->stretch= pg->stretch;
+  int i, n= N(pg->ins);
+  for (i=0; i<n; i++) r->ins << shift_items (pg->ins[i], d);
+  return r;
+}
+
+static void
+page_extents (pagelet pg, int& lo, int& hi, int& e) {
+  // lo and hi bound the page items which occur on the page,
+  // either directly or through one of their insertions,
+  // and e is the end of the main text on the page
+  int i, n= N(pg->ins);
+  for (i=0; i<n; i++) {
+    insertion ins= pg->ins[i];
+    if (N(ins->sk) != 0) {
+      int j, k= N(ins->sk);
+      for (j=0; j<k; j++) page_extents (ins->sk[j], lo, hi, e);
+    }
+    else if (is_atom (ins->begin)) {
+      lo= min (lo, ins->begin->item);
+      hi= max (hi, ins->end->item);
+      e = max (e , ins->end->item);
+    }
+    else if (!is_nil (ins->begin)) {
+      lo= min (lo, ins->begin->item);
+      hi= max (hi, ins->begin->item + 1);
+    }
+  }
+}
+
+static array<int>
+clean_breaks (skeleton sk) {
+  // for each page, the position of the page break after it, if clean,
+  // and -1 otherwise
+  int k, m= N(sk), hi= -1;
+  array<int> lo (m), brk (m);
+  for (k=0; k<m; k++) {
+    int e= -1;
+    lo[k]= MAX_SI;
+    page_extents (sk[k], lo[k], hi, e);
+    brk[k]= (e >= 0 && hi <= e)? e: -1;
+  }
+  int low= MAX_SI;
+  for (k=m-1; k>=0; k--) {
+    if (brk[k] > low) brk[k]= -1;
+    low= min (low, lo[k]);
+  }
+  return brk;
+}
+
+static bool
+breaks_pages (page_item item) {
+  return (item->type == PAGE_CONTROL_ITEM) &&
+    ((item->t == PAGE_BREAK) || (item->t == NEW_PAGE) ||
+     (item->t == NEW_DPAGE) ||
+     (is_tuple (item->t, "env_page") && (item->t[1] == PAGE_NR)));
+}
+
+static bool
+breaks_pages (array<page_item> l, int start, int end) {
+  int i;
+  for (i=start; i<end; i++)
+    if (breaks_pages (l[i])) return true;
+  return false;
+}
+
+static skeleton
+break_window (array<page_item> l, int start, int end, bool last,
+              space ph, int qual,
+              space fn_sep, space fnote_sep, space float_sep,
+              font fn, int first_page)
+{
+  int i, n= end - start;
+  array<page_item> w (n);
+  for (i=0; i<n; i++) w[i]= l[start + i];
+  // the page breakers reset the penalty of the last item
+  w[n-1]= copy (w[n-1]);
+  skeleton sk= break_pages (w, ph, qual, fn_sep, fnote_sep, float_sep,
+                            fn, first_page, last);
+  skeleton r;
+  for (i=0; i<N(sk); i++) r << shift_items (sk[i], start);
+  return r;
+}
+
+static skeleton
+break_pages_from (array<page_item> l, space ph, int qual,
+                  space fn_sep, space fnote_sep, space float_sep,
+                  font fn, int first_page,
+                  skeleton prev_sk, array<int> brk, int prev_n,
+                  int kept, int start, int end)
+{
+  // keep the first kept old pages and break the following pages, until the
+  // new page breaks meet an old page break after end; we return an empty
+  // skeleton if all pages have to be broken
+  int i, k, n= N(l), m= N(prev_sk), d= n - prev_n;
+  int s= (kept == 0? 0: brk[kept-1]);
+  if ((s < start) && (l[s]->type == PAGE_CONTROL_ITEM) &&
+      ((l[s]->t == PAGE_BREAK) || (l[s]->t == NEW_PAGE)))
+    s++;
+
+  // old page breaks at which we may synchronize
+  array<int> sync;
+  hashmap<int,int> sync_page (-1);
+  for (k=kept; k+1<m; k++)
+    if ((brk[k] >= 0) && (brk[k] < prev_n) &&
+        (brk[k] + d >= end) && (brk[k] + d > s)) {
+      sync << brk[k];
+      sync_page (brk[k])= k;
+    }
+
+  // break pages in larger and larger windows
+  skeleton sk;
+  for (k=0; k<kept; k++) sk << prev_sk[k];
+  int look= 2;
+  while (look <= N(sync)) {
+    int last= sync[look-1] + d;
+    if (breaks_pages (l, s, last + 1)) break;
+    skeleton w= break_window (l, s, last, false, ph, qual,
+                              fn_sep, fnote_sep, float_sep, fn, first_page);
+    array<int> wbrk= clean_breaks (w);
+    for (i=0; i+1<N(w); i++)
+      if ((wbrk[i] >= end) && sync_page->contains (wbrk[i] - d)) {
+        int j, p= wbrk[i];
+        k= sync_page[p - d];
+        // an odd shift of the page numbers affects later double pages
+        if ((((kept + i) - k) & 1) != 0)
+          for (j=p; j<n; j++)
+            if ((l[j]->type == PAGE_CONTROL_ITEM) && (l[j]->t == NEW_DPAGE))
+              return skeleton ();
+        for (j=0; j<=i; j++) sk << w[j];
+        for (j=k+1; j<m; j++) sk << shift_items (prev_sk[j], d);
+        return sk;
+      }
+    look <<= 1;
+  }
+
+  // no synchronization: break all remaining pages
+  if ((s >= n) || breaks_pages (l, s, n)) return skeleton ();
+  sk << break_window (l, s, n, true, ph, qual,
+                      fn_sep, fnote_sep, float_sep, fn, first_page);
+  return sk;
+}
+
+skeleton
+break_pages (array<page_item> l, space ph, int qual,
+	     space fn_sep, space fnote_sep, space float_sep,
+             font fn, int first_page,
+             skeleton prev_sk, int prev_n, int start, int end)
+{
+  int k, n= N(l), m= N(prev_sk), d= n - prev_n;
+  if ((start == end) && (d == 0)) return prev_sk;
+  if ((ph == (MAX_SI >> 1)) || (m == 0) || (n == 0))
+    return break_pages (l, ph, qual, fn_sep, fnote_sep, float_sep,
+                        fn, first_page);
+
+  // old pages after which we may start to break pages again
+  array<int> brk= clean_breaks (prev_sk);
+  array<int> starts;
+  starts << 0;
+  for (k=0; k+1<m; k++)
+    if ((brk[k] >= 0) && (brk[k] <= start)) starts << (k+1);
+
+  // the change may also move the page breaks before it: start earlier
+  // and earlier, until the first page which is broken again is unchanged
+  int back= 2;
+  while (true) {
+    int kept= starts[max (N(starts) - back, 0)];
+    skeleton sk=
+      break_pages_from (l, ph, qual, fn_sep, fnote_sep, float_sep,
+                        fn, first_page, prev_sk, brk, prev_n,
+                        kept, start, end);
+    if (N(sk) == 0)
+      return break_pages (l, ph, qual, fn_sep, fnote_sep, float_sep,
+                          fn, first_page);
+    if ((kept == 0) || ((N(sk) > kept) && (sk[kept] == prev_sk[kept])))
+      return sk;
+    back <<= 1;
   }
 }
@@ -17,6 +17,21 @@
 #include "Format/stack_border.hpp"
 #include "Page/skeleton.hpp"
 
+struct page_breaking_problem {
+  array<page_item> l;      // the page items to be broken into pages
+  space ht;                // the page height
+  int   quality;           // the quality of the page breaking
+  space fn_sep;            // inter-footnote separation
+  space fnote_sep;         // separation between footnotes and main text
+  space float_sep;         // separation between text or floats and floats
+  font  fn;                // the main font
+  int   first_page;        // the number of the first page
+};
+
+// when set, the page breaking problems which are solved during
+// typesetting are appended to this array (used for comparing breakers)
+extern array<page_breaking_problem>* page_breaking_trace;
+
 class pager_rep {
 public:
   path                 ip;
@@ -55,6 +70,10 @@ public:
   array<box>   lines_bx;
   array<space> lines_ht;
 
+  array<page_item> prev_l;    // page items of a previous page breaking
+  skeleton         prev_sk;   // the resulting skeleton
+  string           prev_pars; // and the page breaking parameters
+
 protected: // making papyrus boxes
   array<page_item> pap_main;
   array<page_item> pap_fnote;
@@ -114,6 +114,7 @@ class box {
   bool operator == (box b2);
   bool operator != (box b2);
   friend inline int N (box b);
+  friend void share (box b);
 };
 
 class box_rep: public abstract_struct {
@@ -292,6 +293,7 @@ inline SI box_rep::sy4 (int i) { box b= subbox(i); return b->y0+ b->y4; }
 inline box box::operator [] (int i) { return rep->subbox(i); }
 inline int N (box b) { return b.rep->subnr(); }
 tm_ostream& operator << (tm_ostream& out, box b);
+void share (box b);
 SI   get_delta (SI x, SI x1, SI x2);
 bool outside (SI x, SI delta, SI x1, SI x2);
 void make_eps (url dest, box b, int dpi= 600);
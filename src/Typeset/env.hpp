@@ -76,6 +76,68 @@
 #define Env_Text_At_Repulse   43
 #define Env_Doc_At_Valign     44
 
+/******************************************************************************
+* Slots for the most frequently read environment variables
+******************************************************************************/
+
+#define Slot_Font               0
+#define Slot_Font_Family        1
+#define Slot_Font_Series        2
+#define Slot_Font_Shape         3
+#define Slot_Font_Size          4
+#define Slot_Font_Base_Size     5
+#define Slot_Font_Effects       6
+#define Slot_Math_Font          7
+#define Slot_Math_Font_Family   8
+#define Slot_Math_Font_Series   9
+#define Slot_Math_Font_Shape   10
+#define Slot_Prog_Font         11
+#define Slot_Prog_Font_Family  12
+#define Slot_Prog_Font_Series  13
+#define Slot_Prog_Font_Shape   14
+#define Slot_Mode              15
+#define Slot_Info_Flag         16
+#define Slot_Language          17
+#define Slot_Math_Language     18
+#define Slot_Prog_Language     19
+#define Slot_Color             20
+#define Slot_Opacity           21
+#define Slot_Line_Width        22
+#define Slot_No_Patterns       23
+#define Slot_Zoom_Factor       24
+#define Slot_Magnification     25
+#define Slot_Magnify           26
+#define Slot_Length_Mode       27
+#define Slot_Math_Level        28
+#define Slot_Math_Display      29
+#define Slot_Math_Condensed    30
+#define Slot_Math_Vpos         31
+#define Slot_Math_Nesting_Level 32
+#define Slot_Par_Mode          33
+#define Slot_Par_Flexibility   34
+#define Slot_Par_Hyphen        35
+#define Slot_Par_Min_Penalty   36
+#define Slot_Par_Left          37
+#define Slot_Par_Right         38
+#define Slot_Par_Sep           39
+#define Slot_Par_Hor_Sep       40
+#define Slot_Par_Ver_Sep       41
+#define Slot_Par_Line_Sep      42
+#define Slot_Par_Par_Sep       43
+#define Slot_Par_Columns       44
+#define Slot_Par_Swell         45
+#define Slot_Par_First         46
+#define Slot_Par_No_First      47
+#define Slot_Par_Kerning_Reduce 48
+#define Slot_Par_Kerning_Stretch 49
+#define Slot_Par_Kerning_Margin 50
+#define Slot_Par_Contraction   51
+#define Slot_Par_Expansion     52
+#define Slot_Par_Spacing       53
+#define Slot_Atom_Decorations  54
+#define Slot_Xoff_Decorations  55
+#define Env_Slots              56
+
 /******************************************************************************
 * For style file editing
 ******************************************************************************/
@@ -123,6 +185,12 @@
 * The edit environment
 ******************************************************************************/
 
+#ifdef TRACE_ENV_LOOKUPS
+// when set, the names of the variables read during typesetting are
+// appended to this array (used for benchmarking the hashmaps)
+extern array<string>* env_lookup_trace;
+#endif
+
 class edit_env;
 class ornament_parameters;
 class art_box_parameters;
@@ -132,6 +200,9 @@ public:
 private:
   hashmap<string,tree>         env;
   hashmap<string,tree>         back;
+  tree*                        slot[Env_Slots]; // locations in env of the
+  hashmap_rep<string,tree>*    slot_env;        // slotted variables, valid
+  unsigned int                 slot_stamp;      // while env is not rehashed
 public:
   hashmap<string,path>         src;
   list<hashmap<string,tree> >  macro_arg;
@@ -471,7 +542,19 @@ public:
     tree& val= env (s); t= exec(t); if (val != t) {
       back->write_back (s, env); val= t; update (s); } }
   inline bool provides (string s) { return env->contains (s); }
-  inline tree read (string s) { return env [s]; }
+  inline tree read (string s) {
+#ifdef TRACE_ENV_LOOKUPS
+    if (env_lookup_trace != NULL) (*env_lookup_trace) << s;
+#endif
+    return env [s]; }
+  inline tree read (int i) {
+    if (slot_env != env.operator -> () || slot_stamp != env->stamp)
+      reset_slots ();
+    tree* val= slot[i];
+    if (val == NULL) val= locate_slot (i);
+    return val == NULL? env->init: *val; }
+  void  reset_slots ();
+  tree* locate_slot (int i);
   tree local_begin_extents (box b);
   void local_end_extents (tree t);
 
@@ -543,31 +626,53 @@ public:
 
   /* retrieving environment variables */
   inline bool get_bool (string var) {
-    tree t= env [var];
+    tree t= read (var);
     if (is_compound (t)) return false;
     return as_bool (t->label); }
   inline int get_int (string var) {
-    tree t= env [var];
+    tree t= read (var);
     if (is_compound (t)) return 0;
     return as_int (t->label); }
   inline double get_double (string var) {
-    tree t= env [var];
+    tree t= read (var);
     if (is_compound (t)) return 0.0;
     return as_double (t->label); }
   inline string get_string (string var) {
-    tree t= env [var];
+    tree t= read (var);
     if (is_compound (t)) return "";
     return t->label; }
   inline SI get_length (string var) {
-    tree t= env [var];
+    tree t= read (var);
     return as_length (t); }
   inline space get_vspace (string var) {
-    tree t= env [var];
+    tree t= read (var);
     return as_vspace (t); }
   inline color get_color (string var) {
-    tree t= env [var];
+    tree t= read (var);
     return named_color (as_string (t), alpha); }
 
+  /* retrieving slotted environment variables */
+  inline bool get_bool (int i) {
+    tree t= read (i);
+    if (is_compound (t)) return false;
+    return as_bool (t->label); }
+  inline int get_int (int i) {
+    tree t= read (i);
+    if (is_compound (t)) return 0;
+    return as_int (t->label); }
+  inline double get_double (int i) {
+    tree t= read (i);
+    if (is_compound (t)) return 0.0;
+    return as_double (t->label); }
+  inline string get_string (int i) {
+    tree t= read (i);
+    if (is_compound (t)) return "";
+    return t->label; }
+  inline SI get_length (int i) {
+    return as_length (read (i)); }
+  inline space get_vspace (int i) {
+    return as_vspace (read (i)); }
+
   friend class edit_env;
   friend tm_ostream& operator << (tm_ostream& out, edit_env env);
 };
@@ -394,6 +394,7 @@ load_style_tree (string package) {
   if (!load_string (name, doc_s, false)) {
     tree doc= texmacs_document_to_tree (doc_s);
     if (is_compound (doc)) doc= extract (doc, "body");
+    doc= intern (doc);
     style_tree_cache (package)= doc;
     return doc;
   }
@@ -55,11 +55,16 @@ editor_rep::editor_rep (vau_buffer buf2):
        buf->data->ref, (buf->prj==NULL? grefs: buf->prj->data->ref),
        buf->data->aux, (buf->prj==NULL? buf->data->aux: buf->prj->data->aux),
        buf->data->att, (buf->prj==NULL? buf->data->att: buf->prj->data->att)),
-  ttt (new_typesetter (env, subtree (et, rp), reverse (rp))) {
+  ttt (new_typesetter (env, subtree (et, rp), reverse (rp))),
+  ed_obs (edit_observer (this)), env_change (0), view_dpi (""), view_pars (-1) {
+    attach_observer (subtree (et, rp), ed_obs);
     init_update ();
 }
 
-editor_rep::~editor_rep () { delete_typesetter (ttt); }
+editor_rep::~editor_rep () {
+  detach_observer (subtree (et, rp), ed_obs);
+  delete_typesetter (ttt);
+}
 
 typesetter editor_rep::get_typesetter () { return ttt; }
 tree editor_rep::get_style () { return the_style; }
@@ -296,8 +301,19 @@ editor_rep::typeset_prepare () {
   env->read_only= buf->buf->read_only;
   env->write_default_env ();
   env->patch_env (pre);
+  if (view_dpi != "") {
+    // settings for rendering pages as images, as in print_doc
+    env->write (DPI, view_dpi);
+    env->write (PAGE_SHOW_HF, "true");
+    env->write (PAGE_SCREEN_MARGIN, "false");
+    env->write (PAGE_BORDER, "none");
+  }
   env->style_init_env ();
   env->update ();
+  if (view_dpi != "" && is_func (env->read (BG_COLOR), PATTERN)) {
+    env->write (BG_COLOR, env->exec (env->read (BG_COLOR)));
+    env->update ();
+  }
 }
 
 void
@@ -890,7 +906,8 @@ editor_rep::typeset_sub (SI& x1, SI& y1, SI& x2, SI& y2) {
 #ifdef USE_EXCEPTIONS
   try {
 #endif
-    eb= ::typeset (ttt, x1, y1, x2, y2);
+    if (view_pars >= 0) eb= ::typeset_partial (ttt, view_pars, x1, y1, x2, y2);
+    else eb= ::typeset (ttt, x1, y1, x2, y2);
 #ifdef USE_EXCEPTIONS
   }
   catch (string msg) {
@@ -1128,76 +1145,218 @@ editor_rep::the_subtree (path p) {
   return subtree (et, p);
 }
 
-//FIXME: stubs
-void editor_rep::notify_change (int changed) {}
-bool editor_rep::has_changed (int question) { return false; }
+/******************************************************************************
+* Notification of changes
+******************************************************************************/
+
+void
+editor_rep::notify_change (int change) {
+  env_change= env_change | change;
+  if ((change & (THE_TREE + THE_ENVIRONMENT)) != 0)
+    typeset_invalidate_env ();
+}
+
+bool
+editor_rep::has_changed (int question) {
+  return (env_change & question) != 0;
+}
+
+//FIXME: stub
 bool editor_rep::inside_graphics (bool b) { return false; }
 
+/******************************************************************************
+* Modifications of the document are passed on to the typesetter,
+* so that only the modified paragraphs have to be typeset again
+******************************************************************************/
 
+void
+editor_rep::notify_assign (path p, tree u) {
+  if (!(rp <= p)) return;
+  ::notify_assign (ttt, p / rp, u);
+  notify_change (THE_TREE);
+}
 
 void
-editor_rep::typeset_document (string image_dpi) {
-  bool conform= true;
+editor_rep::notify_insert (path p, tree u) {
+  if (!(rp <= p)) return;
+  ::notify_insert (ttt, p / rp, u);
+  notify_change (THE_TREE);
+}
 
-  typeset_preamble ();
-  
-  // Set environment variables for printing
+void
+editor_rep::notify_remove (path p, int nr) {
+  if (!(rp <= p)) return;
+  ::notify_remove (ttt, p / rp, nr);
+  notify_change (THE_TREE);
+}
 
-  typeset_prepare ();
-  env->write (DPI, image_dpi);
-  env->write (PAGE_SHOW_HF, "true");
-  env->write (PAGE_SCREEN_MARGIN, "false");
-  env->write (PAGE_BORDER, "none");
-  if (is_func (env->read (BG_COLOR), PATTERN))
-    env->write (BG_COLOR, env->exec (env->read (BG_COLOR)));
+void
+editor_rep::notify_split (path p) {
+  if (!(rp <= p)) return;
+  ::notify_split (ttt, p / rp);
+  notify_change (THE_TREE);
+}
 
-  if (!conform) {
-    env->write (PAGE_MEDIUM, "paper");
-    env->write (PAGE_PRINTED, "true");
+void
+editor_rep::notify_join (path p) {
+  if (!(rp <= p)) return;
+  ::notify_join (ttt, p / rp);
+  notify_change (THE_TREE);
+}
+
+void
+editor_rep::notify_assign_node (path p, tree_label op) {
+  if (!(rp <= p)) return;
+  ::notify_assign_node (ttt, p / rp, op);
+  notify_change (THE_TREE);
+}
+
+void
+editor_rep::notify_insert_node (path p, tree t) {
+  if (!(rp <= p)) return;
+  ::notify_insert_node (ttt, p / rp, t);
+  notify_change (THE_TREE);
+}
+
+void
+editor_rep::notify_remove_node (path p) {
+  if (!(rp <= p)) return;
+  ::notify_remove_node (ttt, p / rp);
+  notify_change (THE_TREE);
+}
+
+/******************************************************************************
+* Typesetting for viewing
+******************************************************************************/
+
+
+
+void
+editor_rep::typeset_view_reset (string image_dpi) {
+  if (image_dpi != view_dpi || is_nil (eb) || has_changed (THE_ENVIRONMENT)) {
+    view_dpi= image_dpi;
+    typeset_invalidate_all ();
   }
+}
 
-  // Typeset pages for printing
-  // FIXME: we want maybe to typeset only the page we need ?
+void
+editor_rep::typeset_view_pars (int nr) {
+  // typeset the first nr paragraphs only, or everything if nr >= n
+  int n= N(subtree (et, rp));
+  view_pars= (nr >= n? -1: nr);
+  typeset_forced ();
+  env_change= 0;
+}
+
+void
+editor_rep::typeset_document (string image_dpi) {
+  // The typesetter ttt is kept alive across calls: modifications of the
+  // document are routed to it through the edit observer, so that only
+  // the modified paragraphs are typeset again.
+  if (!is_nil (eb) && image_dpi == view_dpi && view_pars < 0 &&
+      !has_changed (THE_TREE + THE_ENVIRONMENT))
+    return;
+  typeset_view_reset (image_dpi);
+  typeset_view_pars (-1);
+}
+
+void
+editor_rep::typeset_document_until (string image_dpi, int page) {
+  // Only typeset as many paragraphs as needed for pages 1..page.
+  // Since the last page of a partially typeset document may still
+  // change, we need at least page+1 pages.  Paragraphs which were
+  // typeset before are cached by the bridges, so that doubling the
+  // number of paragraphs at each attempt is cheap.  After a change,
+  // we restart from the previous number of paragraphs, so that a document
+  // which was typeset further (or completely) is not cut back.
+  if (!is_nil (eb) && image_dpi == view_dpi &&
+      !has_changed (THE_TREE + THE_ENVIRONMENT) &&
+      (view_pars < 0 || N(eb[0]) > page))
+    return;
+  int nr= 16;
+  if (!is_nil (eb) && image_dpi == view_dpi)
+    nr= (view_pars < 0? -1: max (view_pars, 16));
+  typeset_view_reset (image_dpi);
+  while (true) {
+    typeset_view_pars (nr);
+    if (view_pars < 0 || N(eb[0]) > page) break;
+    nr= 2*nr;
+  }
+}
+
+bool
+editor_rep::typeset_document_continue () {
+  // Typeset some more paragraphs of a partially typeset document.
+  // Returns true when the complete document has been typeset.
+  // A completely typeset document is typeset completely again after
+  // a change; the unchanged paragraphs are cached by the bridges.
+  if (view_dpi == "") return true;
+  if (view_pars < 0 && !has_changed (THE_TREE + THE_ENVIRONMENT))
+    return true;
+  int nr= (view_pars < 0? -1: 2*view_pars);
+  typeset_view_reset (view_dpi);
+  typeset_view_pars (nr);
+  return view_pars < 0;
+}
+
+static picture
+render_page (box pages, int page, double zoomf, tree bg) {
+  // the position of the page inside pages should already be reset
+  box b=  pages[page];
+  SI pixel= 5*PIXEL;
+  SI w= b->x4 - b->x3;
+  SI h= b->y4 - b->y3;
+  SI ww= (SI) round (zoomf * w);
+  SI hh= (SI) round (zoomf * h);
+  int pxw= (ww+pixel-1)/pixel;
+  int pxh= (hh+pixel-1)/pixel;
+  picture pic= native_picture (pxw, pxh, 0, 0);
+  renderer ren= picture_renderer (pic, zoomf);
+  {
+    ren->set_background (bg);
+    if (bg != "white" && bg != "#ffffff")
+      ren->clear_pattern (0, (SI) -h, (SI) w, 0);
 
-  eb= typeset_as_document (env, subtree (et, rp), reverse (rp));
+    rectangles rs;
+    b->redraw (ren, path (0), rs);
+  }
+  tm_delete (ren);
+  return pic;
 }
 
 picture
 editor_rep::get_page_picture (int page) {
+  if (view_dpi != "") typeset_document_until (view_dpi, page);
   box the_box= eb;
   page= min(N(the_box[0]), max (0, page-1));
-  {
-    box b=  the_box[0][page];
-    double zoomf= 5.0;
-    
-    SI pixel= 5*PIXEL;
-    SI w= b->x4 - b->x3;
-    SI h= b->y4 - b->y3;
-    SI ww= (SI) round (zoomf * w);
-    SI hh= (SI) round (zoomf * h);
-    int pxw= (ww+pixel-1)/pixel;
-    int pxh= (hh+pixel-1)/pixel;
-    picture pic= native_picture (pxw, pxh, 0, 0);
-    renderer ren= picture_renderer (pic, zoomf);
-    {
-      tree bg= env->read (BG_COLOR);
-      ren->set_background (bg);
-      if (bg != "white" && bg != "#ffffff")
-        ren->clear_pattern (0, (SI) -h, (SI) w, 0);
-      
-      rectangles rs;
-      the_box[0]->sx(page)= 0;
-      the_box[0]->sy(page)= 0;
-      the_box[0][page]->redraw (ren, path (0), rs);
-      //      if (i<end-1) ren->next_page ();
-    }
-    tm_delete (ren);
-    return pic;
+  the_box[0]->sx(page)= 0;
+  the_box[0]->sy(page)= 0;
+  return render_page (the_box[0], page, 5.0, env->read (BG_COLOR));
+}
+
+array<picture>
+editor_rep::get_page_pictures (int start, int end, double zoomf) {
+  // Render the pages start, ..., end-1 (counting from 1) at the given zoom.
+  // The pages are rendered one after the other: fonts and their glyph tables
+  // are loaded lazily and are not safe for concurrent redraws.
+  if (view_dpi != "") typeset_document_until (view_dpi, end-1);
+  box pages= eb[0];
+  start= max (start, 1);
+  end  = min (end, N(pages) + 1);
+  if (end <= start) return array<picture> ();
+  array<picture> pics (end - start);
+  tree bg= env->read (BG_COLOR);
+  for (int i=start-1; i<end-1; i++) {
+    pages->sx(i)= 0;
+    pages->sy(i)= 0;
+    pics[i-start+1]= render_page (pages, i, zoomf, bg);
   }
+  return pics;
 }
 
 picture
 editor_rep::get_view_picture (int page, int width, int height, double zoomf) {
+  if (view_dpi != "") typeset_document_until (view_dpi, page);
   box the_box= eb;
   page= min(N(the_box[0]), max (0, page-1));
   {
@@ -1233,62 +1392,6 @@ editor_rep::get_view_picture (int page, int width, int height, double zoomf) {
 
 void
 editor_rep::get_page_image (url name, int page, string image_dpi) {
-
-  bool conform= true;
-  url  orig= resolve (name, "");
-
-  typeset_preamble ();
-  
-  // Set environment variables for printing
-
-  typeset_prepare ();
-  env->write (DPI, image_dpi);
-  env->write (PAGE_SHOW_HF, "true");
-  env->write (PAGE_SCREEN_MARGIN, "false");
-  env->write (PAGE_BORDER, "none");
-  if (is_func (env->read (BG_COLOR), PATTERN))
-    env->write (BG_COLOR, env->exec (env->read (BG_COLOR)));
-
-  if (!conform) {
-    env->write (PAGE_MEDIUM, "paper");
-    env->write (PAGE_PRINTED, "true");
-  }
-
-  // Typeset pages for printing
-  // FIXME: we want maybe to typeset only the page we need ?
-
-  box the_box= typeset_as_document (env, subtree (et, rp), reverse (rp));
-
-  page= min(N(the_box[0]), max (0, page-1));
-  the_box[0]->sx(page)= 0;
-  the_box[0]->sy(page)= 0;
-  
-  {
-    box b=  the_box[0][page];
-    double zoomf= 5.0;
-
-    SI pixel= 5*PIXEL;
-    SI w= b->x4 - b->x3;
-    SI h= b->y4 - b->y3;
-    SI ww= (SI) round (zoomf * w);
-    SI hh= (SI) round (zoomf * h);
-    int pxw= (ww+pixel-1)/pixel;
-    int pxh= (hh+pixel-1)/pixel;
-    picture pic= native_picture (pxw, pxh, 0, 0);
-    renderer ren= picture_renderer (pic, zoomf);
-    {
-      tree bg= env->read (BG_COLOR);
-      ren->set_background (bg);
-      if (bg != "white" && bg != "#ffffff")
-        ren->clear_pattern (0, (SI) -h, (SI) w, 0);
-      
-      rectangles rs;
-      the_box[0]->sx(page)= 0;
-      the_box[0]->sy(page)= 0;
-      the_box[0][page]->redraw (ren, path (0), rs);
-      //      if (i<end-1) ren->next_page ();
-    }
-    tm_delete (ren);
-    save_picture (name, pic);
-  }
+  typeset_document_until (image_dpi, page);
+  save_picture (name, get_page_picture (page));
 }
@@ -59,6 +59,10 @@ protected:
   hashmap<string,tree> grefs;             // global references
   edit_env env;                           // the environment for typesetting
   typesetter ttt;                         // the (not) yet typesetted document
+  observer ed_obs;                        // routes modifications to ttt
+  int env_change;                         // which things have been changed ?
+  string view_dpi;                        // dpi for viewing ("" if editing)
+  int view_pars;                          // paragraphs typeset (-1 for all)
 
 protected:
   typesetter           get_typesetter ();
@@ -84,6 +88,16 @@ public:
   // from edit_interface
   virtual void notify_change (int changed);
   virtual bool has_changed (int question);
+
+  // from edit_modify
+  void notify_assign      (path p, tree u);
+  void notify_insert      (path p, tree u);
+  void notify_remove      (path p, int nr);
+  void notify_split       (path p);
+  void notify_join        (path p);
+  void notify_assign_node (path p, tree_label op);
+  void notify_insert_node (path p, tree t);
+  void notify_remove_node (path p);
   
   // from edit_graphics
   virtual bool   inside_graphics (bool b=true);
@@ -177,8 +191,13 @@ public:
   // interface
   void get_page_image (url name, int page, string image_dpi);
   picture get_page_picture (int page);
+  array<picture> get_page_pictures (int start, int end, double zoomf);
   picture get_view_picture (int page, int width, int height, double zoomf);
+  void typeset_view_reset (string image_dpi);
+  void typeset_view_pars (int nr);
   void typeset_document (string image_dpi);
+  void typeset_document_until (string image_dpi, int page);
+  bool typeset_document_continue ();
   
   friend class editor;
 
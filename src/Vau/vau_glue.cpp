@@ -1132,6 +1132,7 @@ TMSCM_CONVERSION(list_string)
 #include "new_style.hpp"
 #include "persistent.hpp"
 #include "font.hpp"
+#include "Format/line_item.hpp"
 
 /******************************************************************************
 * Miscellaneous routines for use by glue only
@@ -1382,6 +1383,8 @@ DECLARE_GLUE_NAME_TYPE(register_glyph,"glyph-register", void (string, array_arra
 DECLARE_GLUE_NAME_TYPE(recognize_glyph,"glyph-recognize", string (array_array_array_double))
 DECLARE_GLUE_NAME_TYPE(set_new_fonts,"set-new-fonts", void (bool))
 DECLARE_GLUE_NAME_TYPE(get_new_fonts,"new-fonts?", bool ())
+DECLARE_GLUE_NAME_TYPE(set_new_line_breaking,"set-new-line-breaking", void (bool))
+DECLARE_GLUE_NAME_TYPE(get_new_line_breaking,"new-line-breaking?", bool ())
 DECLARE_GLUE_NAME_TYPE(eqnumber_to_nonumber,"tmtm-eqnumber->nonumber", tree (tree))
 DECLARE_GLUE_NAME_TYPE(is_busy_versioning,"busy-versioning?", bool ())
 DECLARE_GLUE_NAME_TYPE(players_set_elapsed,"players-set-elapsed", void (tree, double))
@@ -17,14 +17,45 @@
 #include "vau_editor.hpp"
 #include "file.hpp"
 #include "merge_sort.hpp"
+#include "iterator.hpp"
 #include "drd_std.hpp"
 #include "convert.hpp"
 #include "boot.hpp"
 #include "data_cache.hpp"
+#include "Freetype/tt_face.hpp"
+#include "Page/pager.hpp"
+#include "Format/line_item.hpp"
+#include "MuPDF/mupdf_renderer.hpp"
 
 
 extern void setup_tex (); // from Plugins/Metafont/tex_init.cpp
 extern void init_tex  (); // from Plugins/Metafont/tex_init.cpp
+extern skeleton new_break_pages ( // from Typeset/Page/new_breaker.cpp
+  array<page_item> l, space ph, int qual,
+  space fn_sep, space fnote_sep, space float_sep,
+  font fn, int first_page, bool last);
+extern skeleton classic_break_pages ( // from Typeset/Page/page_breaker.cpp
+  array<page_item> l, space ph, int qual,
+  space fn_sep, space fnote_sep, space float_sep,
+  font fn, int first_page, bool last);
+extern skeleton break_pages ( // from Typeset/Page/page_breaker.cpp
+  array<page_item> l, space ph, int qual,
+  space fn_sep, space fnote_sep, space float_sep,
+  font fn, int first_page);
+extern skeleton break_pages ( // from Typeset/Page/page_breaker.cpp
+  array<page_item> l, space ph, int qual,
+  space fn_sep, space fnote_sep, space float_sep,
+  font fn, int first_page,
+  skeleton prev_sk, int prev_n, int start, int end);
+extern void changed_page_items ( // from Typeset/Page/page_breaker.cpp
+  array<page_item> l1, array<page_item> l2, int& start, int& end);
+extern vpenalty as_vpenalty (SI diff); // from Typeset/Page/vpenalty.cpp
+extern array<path> classic_line_breaks ( // from Typeset/Line/line_breaker.cpp
+  array<line_item> a, int start, int end,
+  SI line_width, SI large_width, SI first_spc, SI last_spc);
+extern array<path> active_line_breaks ( // from Typeset/Line/line_breaker.cpp
+  array<line_item> a, int start, int end,
+  SI line_width, SI large_width, SI first_spc, SI last_spc);
 
 /******************************************************************************
 * Subroutines for paths
@@ -87,6 +118,8 @@ init_user_dirs () {
   make_dir ("$TEXMACS_HOME_PATH/system");
   make_dir ("$TEXMACS_HOME_PATH/system/bib");
   make_dir ("$TEXMACS_HOME_PATH/system/cache");
+  make_dir ("$TEXMACS_HOME_PATH/system/cache/hyphen");
+  make_dir ("$TEXMACS_HOME_PATH/system/cache/metrics");
   make_dir ("$TEXMACS_HOME_PATH/system/database");
   make_dir ("$TEXMACS_HOME_PATH/system/database/bib");
   make_dir ("$TEXMACS_HOME_PATH/system/make");
@@ -123,6 +156,32 @@ plugin_list () {
 }
 
 
+/******************************************************************************
+* Limits of the renderer caches
+******************************************************************************/
+
+static void
+init_mupdf_limits () {
+  // the preferences give sizes in megabytes, or "default"
+  string store= get_user_preference ("mupdf store limit", "default");
+  if (is_int (store)) mupdf_set_store_limit (((size_t) as_int (store)) << 20);
+  string cache= get_user_preference ("mupdf cache limit", "default");
+  if (is_int (cache)) mupdf_set_cache_limit (((size_t) as_int (cache)) << 20);
+}
+
+/******************************************************************************
+* Font metrics
+******************************************************************************/
+
+static void
+init_font_metrics () {
+  // rasterize glyphs in order to determine their ink extents?
+#ifdef USE_FREETYPE
+  string render= get_user_preference ("render glyph metrics", "off");
+  tt_render_metrics (render == "on");
+#endif
+}
+
 /******************************************************************************
 * Set additional environment variables
 ******************************************************************************/
@@ -237,6 +296,8 @@ TeXmacs_main (int argc, char** argv) {
   init_std_drd ();
   //cout << "Initialize -- User preferences\n";
   load_user_preferences ();
+  init_mupdf_limits ();
+  init_font_metrics ();
   //cout << "Initialize -- Environment variables\n";
   init_env_vars ();
   bench_cumul ("initialize vau");
@@ -254,9 +315,16 @@ TeXmacs_main (int argc, char** argv) {
 #ifndef __EMSCRIPTEN__
   extern void test_vau();
   test_vau();
+  if (get_env ("VAU_BENCH") != "") {
+    extern void bench_vau();
+    bench_vau();
+  }
 #endif
 
   cache_memorize ();
+#ifdef USE_FREETYPE
+  tt_metric_cache_save ();
+#endif
   bench_print ();
 }
 
@@ -311,7 +379,15 @@ wasm_open_document (const char *name) {
   cout << "wasm_open_document " << s << LF;
   vau_buffer buf= concrete_buffer_insist (s);
   set_current_editor (new_editor (buf));
-  current_editor ()->typeset_document ("300");
+  current_editor ()->typeset_document_until ("300", 1);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int
+wasm_typeset_continue () {
+  // to be called when idle, until the whole document has been typeset
+  if (is_nil (current_editor ())) return 1;
+  return current_editor ()->typeset_document_continue ()? 1: 0;
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -322,6 +398,15 @@ wasm_get_page_png (int page) {
   save_picture ("$HOME/vau-test.png", pic);
 }
 
+EMSCRIPTEN_KEEPALIVE
+void
+wasm_get_pages_png (int start, int end) {
+  cout << "wasm_get_pages_png " << start << ", " << end << LF;
+  array<picture> pics= current_editor ()->get_page_pictures (start, end, 5.0);
+  for (int i=0; i<N(pics); i++)
+    save_picture ("$HOME/vau-test-" * as_string (start + i) * ".png", pics[i]);
+}
+
 EMSCRIPTEN_KEEPALIVE
 void
 wasm_get_page_pixmap (int page) {
@@ -371,6 +456,440 @@ wasm_eval (const char *s) {
 } // extern "C"
 
 
+static int
+touch_tree (tree t) {
+  // copy the handles of all subtrees of t (for timing reference counts)
+  if (is_atomic (t)) return 1;
+  int i, n= N(t), r= 1;
+  for (i=0; i<n; i++) {
+    tree u= t[i];
+    r += touch_tree (u);
+  }
+  return r;
+}
+
+static void
+bench_ref_count (url name) {
+  // compare with a build configured with SHARED_REF_COUNT; the "typeset"
+  // timings then give the overhead on the typesetting of the document
+  vau_buffer buf= concrete_buffer_insist (name);
+  tree doc= copy (subtree (the_et, buf->rp)); // do not share the document
+  bench_start ("ref count (local)");
+  for (int i=0; i<100; i++) touch_tree (doc);
+  bench_cumul ("ref count (local)");
+#ifdef SHARED_REF_COUNT
+  share (doc);
+  bench_start ("ref count (shared)");
+  for (int i=0; i<100; i++) touch_tree (doc);
+  bench_cumul ("ref count (shared)");
+#else
+  cout << "Shared reference counts disabled (configure with SHARED_REF_COUNT)\n";
+#endif
+}
+
+static void
+bench_hashmap (url name) {
+  // replay the environment lookups made while typesetting the document;
+  // compare with a build configured with CHAINED_HASHMAP.  The lookups are
+  // only recorded with TRACE_ENV_LOOKUPS; otherwise every variable of the
+  // environment is looked up once per round instead.
+  array<string> trace;
+#ifdef TRACE_ENV_LOOKUPS
+  env_lookup_trace= &trace;
+#endif
+  vau_buffer buf= concrete_buffer_insist (name);
+  editor ed= new_editor (buf);
+  ed->typeset_document ("300");
+  hashmap<string,tree> env (UNINIT, ed->get_full_env ());
+#ifdef TRACE_ENV_LOOKUPS
+  env_lookup_trace= NULL;
+#else
+  iterator<string> vars= iterate (env);
+  while (vars->busy ()) trace << vars->next ();
+#endif
+  int i, r, n= N(trace), found= 0;
+  bench_start ("hashmap lookups");
+  for (r=0; r<10; r++)
+    for (i=0; i<n; i++)
+      if (is_compound (env [trace[i]])) found++;
+  bench_cumul ("hashmap lookups");
+  bench_start ("hashmap inserts");
+  for (r=0; r<1000; r++) {
+    hashmap<string,tree> h (UNINIT);
+    iterator<string> it= iterate (env);
+    while (it->busy ()) {
+      string var= it->next ();
+      h (var)= env [var];
+    }
+  }
+  bench_cumul ("hashmap inserts");
+  bench_start ("hashmap copies");
+  for (r=0; r<1000; r++) {
+    hashmap<string,tree> h= copy (env);
+    found += N(h);
+  }
+  bench_cumul ("hashmap copies");
+  cout << "Replayed " << n << " lookups in an environment with "
+       << N(env) << " variables (" << found << ")\n";
+}
+
+static void
+bench_tm_reader (url name) {
+  // throughput of the reader of the TeXmacs format
+  string s;
+  if (load_string (name, s, false)) return;
+  int i, n= 20;
+  time_t start= texmacs_time ();
+  for (i=0; i<n; i++)
+    (void) texmacs_document_to_tree (s);
+  int ms= max ((int) (texmacs_time () - start), 1);
+  double mb= ((double) n) * ((double) N(s)) / 1000000.0;
+  cout << "Read " << mb << " MB of TeXmacs data in " << ms
+       << " ms (" << (1000.0 * mb / ms) << " MB/s)\n";
+}
+
+static int
+check_binary_round_trip (tree t) {
+  // t should survive the conversion to the binary format and back again,
+  // while every truncation of the binary data should be rejected
+  int k, failures= 0;
+  string s= tree_to_texmacs_binary (t);
+  if (texmacs_binary_to_tree (s) != t) {
+    cout << "  Round trip failed for " << t << "\n";
+    failures++;
+  }
+  int step= max (N(s) / 1000, 1);
+  for (k=0; k<N(s); k += step)
+    if (!is_func (texmacs_binary_to_tree (s (0, k)), ERROR)) {
+      cout << "  Truncation at " << k << " of " << N(s) << " accepted\n";
+      failures++;
+    }
+  return failures;
+}
+
+static void
+test_texmacs_binary (url name) {
+  // round trips of the binary format and rejection of corrupt data
+  int failures= 0;
+  string big (300);
+  for (int i=0; i<N(big); i++) big[i]= (char) (i & 255);
+  tree wide (CONCAT, 200);
+  for (int i=0; i<N(wide); i++) wide[i]= as_string (i % 7);
+  tree deep= "x";
+  for (int i=0; i<100; i++) deep= tree (WITH, "color", "red", deep);
+  failures += check_binary_round_trip ("");
+  failures += check_binary_round_trip (tree (DOCUMENT));
+  failures += check_binary_round_trip (tuple ("", big, tree (UNINIT)));
+  failures += check_binary_round_trip (wide);
+  failures += check_binary_round_trip (deep);
+  failures += check_binary_round_trip (compound ("unknown-macro", "a", "b"));
+  string s;
+  if (!load_string (name, s, false))
+    failures += check_binary_round_trip (texmacs_document_to_tree (s));
+
+  string b= tree_to_texmacs_binary (tuple ("a", tree (CONCAT, "b", "c")));
+  array<string> bad;
+  bad << string ("")
+      << ("TMB\002" * b (4, N(b)))       // unknown version
+      << (b * "x")                        // trailing garbage
+      << b (0, N(b) - 1) * "\377";        // unterminated integer
+  string c= copy (b);
+  c[N(c) - 1]= (char) 100;                // string outside the pool
+  bad << c;
+  for (int i=0; i<N(bad); i++)
+    if (!is_func (texmacs_binary_to_tree (bad[i]), ERROR)) {
+      cout << "  Corrupt binary data " << i << " accepted\n";
+      failures++;
+    }
+  cout << "Binary format failures: " << failures << "\n";
+}
+
+static void
+collect_words (tree t, array<string>& words) {
+  if (is_compound (t)) {
+    for (int i=0; i<N(t); i++) collect_words (t[i], words);
+    return;
+  }
+  string s= t->label;
+  int i= 0, n= N(s);
+  while (i < n) {
+    while (i < n && !is_alpha (s[i])) i++;
+    int start= i;
+    while (i < n && is_alpha (s[i])) i++;
+    if (i - start > 4) words << s (start, i);
+  }
+}
+
+static void
+bench_hyphenation (url name) {
+  // hyphenation of the words of the document, as done by the line breaker
+  vau_buffer buf= concrete_buffer_insist (name);
+  array<string> words;
+  collect_words (subtree (the_et, buf->rp), words);
+  language lan= text_language ("english");
+  int i, r, found= 0;
+  bench_start ("hyphenation");
+  for (r=0; r<10; r++)
+    for (i=0; i<N(words); i++)
+      found += N (lan->get_hyphens (words[i]));
+  bench_cumul ("hyphenation");
+  cout << "Hyphenated " << N(words) << " words (" << found << ")\n";
+}
+
+static int
+page_end (pagelet pg) {
+  // the end of the main text on the page
+  int i, e= 0;
+  for (i=0; i<N(pg->ins); i++) {
+    insertion ins= pg->ins[i];
+    if (N(ins->sk) != 0)
+      for (int j=0; j<N(ins->sk); j++) e= max (e, page_end (ins->sk[j]));
+    else if (is_atom (ins->begin)) e= max (e, ins->end->item);
+  }
+  return e;
+}
+
+static void
+page_floats (pagelet pg, string& s) {
+  // the anchors of the floats on the page
+  int i;
+  for (i=0; i<N(pg->ins); i++) {
+    insertion ins= pg->ins[i];
+    if (N(ins->sk) != 0)
+      for (int j=0; j<N(ins->sk); j++) page_floats (ins->sk[j], s);
+    else if (is_tuple (ins->type, "float")) {
+      if (N(s) != 0) s << " ";
+      s << as_string (ins->begin->item) << ":"
+        << as_string (ins->begin->next->item);
+    }
+  }
+}
+
+static tree
+page_statistics (page_breaking_problem pb, skeleton sk) {
+  // for each page, a penalty which does not depend on the page breaker
+  // (the penalty of the break and the deviation from the page height),
+  // together with the floats on the page
+  int k, n= N(sk);
+  tree r (TUPLE);
+  for (k=0; k<n; k++) {
+    pagelet pg= sk[k];
+    int e= page_end (pg);
+    vpenalty pen;
+    if (k < n-1 && e > 0) pen += vpenalty (pb.l[e-1]->penalty);
+    if (k < n-1 || pg->ht->def > pb.ht->def)
+      pen += as_vpenalty (pg->ht->def - pb.ht->def);
+    string fl;
+    page_floats (pg, fl);
+    r << tuple (as_string (pen->pen), as_string (pen->exc), fl);
+  }
+  return r;
+}
+
+static tree
+run_page_breaker (array<page_breaking_problem> pbs, bool new_style) {
+  int i, r, rounds= 5;
+  tree pages (TUPLE);
+  time_t start= texmacs_time ();
+  for (r=0; r<rounds; r++)
+    for (i=0; i<N(pbs); i++) {
+      page_breaking_problem pb= pbs[i];
+      array<page_item> l= copy (pb.l);
+      skeleton sk= new_style?
+        new_break_pages (l, pb.ht, pb.quality, pb.fn_sep, pb.fnote_sep,
+                         pb.float_sep, pb.fn, pb.first_page, true):
+        classic_break_pages (l, pb.ht, pb.quality, pb.fn_sep, pb.fnote_sep,
+                             pb.float_sep, pb.fn, pb.first_page, true);
+      if (r == 0) pages << A (page_statistics (pb, sk));
+    }
+  int us= (int) ((1000 * (texmacs_time () - start)) / rounds);
+  return tuple (as_string (us), pages);
+}
+
+static vpenalty
+total_penalty (tree pages) {
+  vpenalty pen;
+  for (int k=0; k<N(pages); k++)
+    pen += vpenalty (as_int (pages[k][0]), as_int (pages[k][1]));
+  return pen;
+}
+
+static bool
+compare_page_breaks (string what, tree r1, tree r2) {
+  // compare the page breaks r2 with the reference r1
+  tree p1= r1[1], p2= r2[1];
+  int k, worse= 0, better= 0, moved= 0, n= min (N(p1), N(p2));
+  for (k=0; k<n; k++) {
+    vpenalty pen1 (as_int (p1[k][0]), as_int (p1[k][1]));
+    vpenalty pen2 (as_int (p2[k][0]), as_int (p2[k][1]));
+    if (pen1 < pen2) worse++;
+    if (pen2 < pen1) better++;
+    if (p1[k][2] != p2[k][2]) moved++;
+  }
+  vpenalty tot1= total_penalty (p1), tot2= total_penalty (p2);
+  int us1= as_int (r1[0]), us2= as_int (r2[0]);
+  cout << what << ": " << N(p2) << " pages (" << N(p1) << "), penalty "
+       << tot2 << " (" << tot1 << "), " << worse << " worse and "
+       << better << " better pages, " << moved << " pages with other floats, "
+       << us2 << " us (" << us1 << " us)\n";
+  return N(p1) == N(p2) && !(tot1 < tot2) && moved == 0 &&
+         us2 <= us1 + (us1 >> 2) + 1000;
+}
+
+static bool
+check_incremental_page_breaks (page_breaking_problem pb, bool insert) {
+  // edit a paragraph near the end of the document, by removing one of its
+  // lines or by inserting a copy of it, and check that re-breaking the pages
+  // incrementally gives the same pages as a complete page breaking
+  array<page_item> l1= copy (pb.l);
+  int i, n= N(l1), e= (9 * n) / 10;
+  while ((e < n) && ((l1[e]->type != PAGE_LINE_ITEM) || (N(l1[e]->fl) != 0)))
+    e++;
+  if (e >= n) return true;
+  array<page_item> l2;
+  for (i=0; i<n; i++) {
+    if (i == e && insert) l2 << copy (l1[i]);
+    if (i != e || insert) l2 << l1[i];
+  }
+  skeleton sk1=
+    break_pages (l1, pb.ht, pb.quality, pb.fn_sep, pb.fnote_sep,
+                 pb.float_sep, pb.fn, pb.first_page);
+  int start, end;
+  changed_page_items (l1, l2, start, end);
+  skeleton inc=
+    break_pages (l2, pb.ht, pb.quality, pb.fn_sep, pb.fnote_sep,
+                 pb.float_sep, pb.fn, pb.first_page, sk1, n, start, end);
+  skeleton full=
+    break_pages (l2, pb.ht, pb.quality, pb.fn_sep, pb.fnote_sep,
+                 pb.float_sep, pb.fn, pb.first_page);
+  return inc == full;
+}
+
+static editor
+new_paper_editor (vau_buffer buf) {
+  // editor which typesets buf on paper; the shared buffer is left untouched
+  editor ed (buf);
+  new_data data;
+  data->project= buf->data->project;
+  data->style  = buf->data->style;
+  data->init   = copy (buf->data->init);
+  data->fin    = buf->data->fin;
+  data->ref    = buf->data->ref;
+  data->aux    = buf->data->aux;
+  data->att    = buf->data->att;
+  data->init (PAGE_MEDIUM)= "paper";
+  ed->set_data (data);
+  return ed;
+}
+
+static void
+bench_page_breakers (array<url> corpus) {
+  // run the classic and the new page breaker on the page breaking problems
+  // which occur when typesetting the corpus on paper, and compare the results
+  // with each other and with a baseline; remove the baseline to renew it
+  make_dir ("$TEXMACS_HOME_PATH/system/bench");
+  url baseline_file= "$TEXMACS_HOME_PATH/system/bench/page-breakers.scm";
+  tree baseline (TUPLE), results (TUPLE);
+  string s;
+  if (!load_string (baseline_file, s, false)) baseline= scheme_to_tree (s);
+  hashmap<string,tree> old_results (UNINIT);
+  for (int i=0; i<N(baseline); i++)
+    if (N(baseline[i]) == 3) old_results (as_string (baseline[i][0]))= baseline[i];
+  int i, j, regressions= 0, checks= 0, mismatches= 0;
+  for (i=0; i<N(corpus); i++) {
+    array<page_breaking_problem> pbs;
+    page_breaking_trace= &pbs;
+    vau_buffer buf= concrete_buffer_insist (corpus[i]);
+    editor ed= new_paper_editor (buf);
+    ed->typeset_document ("300");
+    page_breaking_trace= NULL;
+    if (N(pbs) == 0) continue;
+    string name= as_string (tail (corpus[i]));
+    tree r1= run_page_breaker (pbs, false);
+    tree r2= run_page_breaker (pbs, true);
+    results << tuple (name, r1, r2);
+    cout << "Page breaking " << name << "\n";
+    (void) compare_page_breaks ("  new vs classic", r1, r2);
+    for (j=0; j<N(pbs); j++)
+      for (int insert=0; insert<2; insert++, checks++)
+        if (!check_incremental_page_breaks (pbs[j], insert == 1)) {
+          cout << "  Incremental page breaking differs from complete one ("
+               << (insert == 1? "inserted": "removed") << " line)\n";
+          mismatches++;
+        }
+    if (old_results->contains (name)) {
+      tree old= old_results [name];
+      if (!compare_page_breaks ("  classic vs baseline", old[1], r1)) {
+        cout << "  Regression of the classic page breaker\n";
+        regressions++;
+      }
+      if (!compare_page_breaks ("  new vs baseline", old[2], r2)) {
+        cout << "  Regression of the new page breaker\n";
+        regressions++;
+      }
+    }
+  }
+  cout << "Page breaking regressions: " << regressions << "\n";
+  cout << "Incremental page breaking mismatches: " << mismatches << " of "
+       << checks << "\n";
+  if (N(baseline) == 0) save_string (baseline_file, tree_to_scheme (results));
+}
+
+static void
+bench_line_breakers (array<url> corpus) {
+  // run the classic and the active line breaker on the justified paragraphs
+  // which occur when typesetting the corpus, and check that both breakers
+  // produce the same breaks
+  int i, j, total= 0, differences= 0;
+  for (i=0; i<N(corpus); i++) {
+    array<line_breaking_problem> lbs;
+    line_breaking_trace= &lbs;
+    vau_buffer buf= concrete_buffer_insist (corpus[i]);
+    editor ed= new_editor (buf);
+    ed->typeset_document ("300");
+    line_breaking_trace= NULL;
+    if (N(lbs) == 0) continue;
+    string name= as_string (tail (corpus[i]));
+    int diff= 0;
+    for (j=0; j<N(lbs); j++) {
+      line_breaking_problem lb= lbs[j];
+      bench_start ("classic line breaker");
+      array<path> ap1=
+        classic_line_breaks (lb.a, lb.start, lb.end, lb.line_width,
+                             lb.large_width, lb.first_spc, lb.last_spc);
+      bench_cumul ("classic line breaker");
+      bench_start ("active line breaker");
+      array<path> ap2=
+        active_line_breaks (lb.a, lb.start, lb.end, lb.line_width,
+                            lb.large_width, lb.first_spc, lb.last_spc);
+      bench_cumul ("active line breaker");
+      if (ap1 != ap2) {
+        if (diff < 3)
+          cout << "  " << name << ", paragraph " << j << ": "
+               << ap2 << " instead of " << ap1 << "\n";
+        diff++;
+      }
+    }
+    cout << "Line breaking " << name << ": " << diff << " of "
+         << N(lbs) << " paragraphs broken differently\n";
+    total += N(lbs);
+    differences += diff;
+  }
+  cout << "Line breaking differences: " << differences << " of "
+       << total << " paragraphs\n";
+}
+
+static array<url>
+tm_files (url dir) {
+  bool error_flag;
+  array<string> a= read_directory (dir, error_flag);
+  merge_sort (a);
+  array<url> r;
+  for (int i=0; i<N(a); i++)
+    if (ends (a[i], ".tm")) r << (dir * a[i]);
+  return r;
+}
+
 void test_vau() {
 //  string name ("$TEXMACS_PATH/vau-tests/grassmann-sq-example.tm");
 //  string name ("$TEXMACS_PATH/examples/texts/bracket-test.tm");
@@ -385,3 +904,18 @@ void test_vau() {
   for (int i=0; i<40; i++) wasm_get_page_pixmap (i);
 //  set_current_editor (editor ());
 }
+
+void bench_vau() {
+  // benchmarks and consistency checks; only run on demand, by setting
+  // the environment variable VAU_BENCH
+  mupdf_cache_statistics ();
+  bench_ref_count ("$TEXMACS_PATH/vau-tests/grassmann-sq-example.tm");
+  bench_hashmap ("$TEXMACS_PATH/vau-tests/grassmann-sq-example.tm");
+  bench_tm_reader ("$TEXMACS_PATH/vau-tests/grassmann-sq-example.tm");
+  test_texmacs_binary ("$TEXMACS_PATH/vau-tests/grassmann-sq-example.tm");
+  bench_hyphenation ("$TEXMACS_PATH/vau-tests/grassmann-sq-example.tm");
+  array<url> corpus= tm_files ("$TEXMACS_PATH/vau-tests");
+  corpus << tm_files ("$TEXMACS_PATH/examples/texts");
+  bench_page_breakers (corpus);
+  bench_line_breakers (corpus);
+}
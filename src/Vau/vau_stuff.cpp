@@ -32,7 +32,36 @@
 
 void
 edit_announce (editor_rep* ed, modification mod) {
-  //FIXME: implement
+  switch (mod->k) {
+  case MOD_ASSIGN:
+    ed->notify_assign (mod->p, mod->t);
+    break;
+  case MOD_INSERT:
+    ed->notify_insert (mod->p, mod->t);
+    break;
+  case MOD_REMOVE:
+    ed->notify_remove (path_up (mod->p), last_item (mod->p));
+    break;
+  case MOD_SPLIT:
+    ed->notify_split (mod->p);
+    break;
+  case MOD_JOIN:
+    ed->notify_join (mod->p);
+    break;
+  case MOD_ASSIGN_NODE:
+    ed->notify_assign_node (mod->p, L(mod));
+    break;
+  case MOD_INSERT_NODE:
+    ed->notify_insert_node (mod->p, mod->t);
+    break;
+  case MOD_REMOVE_NODE:
+    ed->notify_remove_node (mod->p);
+    break;
+  case MOD_SET_CURSOR:
+    // no cursor in Vau
+    break;
+  default: FAILED ("invalid modification type");
+  }
 }
 
 void